@@ -0,0 +1,349 @@
+#include "BigDecimal.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+namespace bigint {
+
+namespace {
+
+// 10^k for the divisors that fit a machine word
+const uint64_t SMALL_POW10[20] = {
+	1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+	1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+	100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+	1000000000000000000ull, 10000000000000000000ull
+};
+
+std::shared_mutex& PowerCacheMutex() {
+	static std::shared_mutex mutex;
+	return mutex;
+}
+
+std::deque<BigInt>& PowerCache() {
+	static std::deque<BigInt> cache(1, BigInt(1ll)); // 10^k at index k
+	return cache;
+}
+
+// 10^k for k <= DECIMAL_POW10_CACHE_LIMIT. Readers share the lock, a miss extends the cache by
+// single cell multiplications. The cache only grows and a deque never moves its elements, so
+// the reference stays valid once the lock is released
+const BigInt& CachedPowerOfTen(uint64_t k) {
+	{
+		std::shared_lock<std::shared_mutex> lock(PowerCacheMutex());
+		if (k < PowerCache().size()) return PowerCache()[k];
+	}
+	std::unique_lock<std::shared_mutex> lock(PowerCacheMutex());
+	std::deque<BigInt>& cache = PowerCache();
+	while (cache.size() <= k) {
+		BigInt next(0ll);
+		next.addmul_1(cache.back(), 10);
+		cache.push_back(next);
+	}
+	return cache[k];
+}
+
+// larger powers are a power of the largest cached one
+BigInt PowerOfTen(uint64_t k) {
+	if (k <= DECIMAL_POW10_CACHE_LIMIT) return CachedPowerOfTen(k);
+	BigInt base = CachedPowerOfTen(DECIMAL_POW10_CACHE_LIMIT);
+	return base.pow(BigInt(int64_t(k / DECIMAL_POW10_CACHE_LIMIT))) * CachedPowerOfTen(k % DECIMAL_POW10_CACHE_LIMIT);
+}
+
+// x *= 10^k, small shifts are single cell passes by 10^9
+void MulPow10(BigInt& x, uint64_t k) {
+	if (k <= DECIMAL_CELL_SCALING_DIGITS) {
+		while (k > 0) {
+			const uint64_t digits = std::min<uint64_t>(k, 9);
+			BigInt product(0ll);
+			product.addmul_1(x, uint32_t(SMALL_POW10[digits]));
+			x = product;
+			k -= digits;
+		}
+	}
+	else if (k <= DECIMAL_POW10_CACHE_LIMIT) {
+		x *= CachedPowerOfTen(k);
+	}
+	else {
+		x *= PowerOfTen(k);
+	}
+}
+
+// q is a quotient truncated toward zero, the exact one being negative or not, inexact when the
+// remainder is not zero, half the sign of 2 * remainder - divisor
+BigInt Round(BigInt q, bool negative, bool inexact, int half, RoundingMode mode) {
+	if (!inexact) return q;
+	bool away = false; // from zero
+	switch (mode) {
+	case RoundingMode::Up:       away = true; break;
+	case RoundingMode::Down:     away = false; break;
+	case RoundingMode::Ceiling:  away = !negative; break;
+	case RoundingMode::Floor:    away = negative; break;
+	case RoundingMode::HalfUp:   away = half >= 0; break;
+	case RoundingMode::HalfDown: away = half > 0; break;
+	case RoundingMode::HalfEven: away = half > 0 || (half == 0 && q.test_bit(0)); break;
+	case RoundingMode::Unnecessary:
+		throw std::domain_error("BigDecimal: rounding necessary");
+	}
+	if (away) {
+		if (negative) --q;
+		else ++q;
+	}
+	return q;
+}
+
+BigInt DivideRounded(const BigInt& num, const BigInt& den, RoundingMode mode) {
+	BigInt remainder;
+	const BigInt q = num.Divide(den, remainder);
+	const bool negative = (num < BigInt(0ll)) != (den < BigInt(0ll));
+	const BigInt twice = remainder + remainder;
+	const int half = twice.ModuloCompareEqual(den) ? 0 : (twice.ModuloCompareGreater(den) ? 1 : -1);
+	return Round(q, negative, remainder.bit_length() != 0, half, mode);
+}
+
+// x / 10^k rounded, divisors up to 10^19 take the single word division
+BigInt DivPow10(const BigInt& x, uint64_t k, RoundingMode mode) {
+	if (k == 0) return x;
+	if (k < 20) {
+		const uint64_t d = SMALL_POW10[k];
+		uint64_t remainder = 0;
+		const BigInt q = x.divmod_ui(d, remainder);
+		const int half = remainder == d - remainder ? 0 : (remainder > d - remainder ? 1 : -1);
+		return Round(q, x < BigInt(0ll), remainder != 0, half, mode);
+	}
+	return DivideRounded(x, PowerOfTen(k), mode);
+}
+
+} // end of anonymous namespace
+
+/*
+* *******************************************************************
+* CONSTRUCTORS & COPY
+* *******************************************************************
+*/
+#pragma region constructors
+
+BigDecimal::BigDecimal() : coeff(0ll), exp10(0) {
+}
+
+BigDecimal::BigDecimal(int64_t num) : coeff(num), exp10(0) {
+}
+
+BigDecimal::BigDecimal(const BigInt& coefficient, int32_t scale) : coeff(coefficient), exp10(scale) {
+}
+
+BigDecimal::BigDecimal(const char* cArray) : exp10(0)
+{
+	// the digits without the point go through the BigInt parser
+	std::string digits;
+	bool fraction = false;
+	int64_t scale = 0;
+	for (const char* c = cArray; *c != '\0'; c++) {
+		if (*c == '.') {
+			if (fraction) throw std::invalid_argument("BigDecimal: invalid number");
+			fraction = true;
+			continue;
+		}
+		if (fraction && *c != '\'') scale++;
+		digits += *c;
+	}
+	if (fraction && digits.find_first_of("xX") != std::string::npos)
+		throw std::invalid_argument("BigDecimal: invalid number");
+	coeff = BigInt(digits.c_str());
+	exp10 = CheckedScale(scale);
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* ALGEBRA OPERATIONS
+* *******************************************************************
+*/
+#pragma region algebOperations
+
+BigDecimal BigDecimal::operator + (const BigDecimal& other) const {
+	if (exp10 == other.exp10)
+		return BigDecimal(coeff + other.coeff, exp10);
+	// the operand with the smaller scale is brought to the larger one
+	if (exp10 > other.exp10) {
+		BigInt aligned = other.coeff;
+		MulPow10(aligned, uint64_t(int64_t(exp10) - other.exp10));
+		return BigDecimal(coeff + aligned, exp10);
+	}
+	BigInt aligned = coeff;
+	MulPow10(aligned, uint64_t(int64_t(other.exp10) - exp10));
+	return BigDecimal(aligned + other.coeff, other.exp10);
+}
+
+BigDecimal BigDecimal::operator - (const BigDecimal& other) const {
+	return *this + (-other);
+}
+
+BigDecimal BigDecimal::operator * (const BigDecimal& other) const {
+	return BigDecimal(coeff * other.coeff, CheckedScale(int64_t(exp10) + other.exp10));
+}
+
+BigDecimal BigDecimal::operator / (const BigDecimal& other) const {
+	return divide(other, CheckedScale(int64_t(std::max(exp10, other.exp10)) + DECIMAL_DIVISION_EXTRA_DIGITS));
+}
+
+void BigDecimal::operator += (const BigDecimal& other) {
+	*this = *this + other;
+}
+
+void BigDecimal::operator -= (const BigDecimal& other) {
+	*this = *this - other;
+}
+
+void BigDecimal::operator *= (const BigDecimal& other) {
+	*this = *this * other;
+}
+
+void BigDecimal::operator /= (const BigDecimal& other) {
+	*this = *this / other;
+}
+
+BigDecimal BigDecimal::operator - () const {
+	return BigDecimal(-coeff, exp10);
+}
+
+BigDecimal BigDecimal::operator + () const {
+	return *this;
+}
+
+// the result coefficient is coeff * 10^e / divisor.coeff with e = scale - exp10 + divisor.exp10,
+// the power of ten goes to the dividend or to the divisor depending on the sign of e
+BigDecimal BigDecimal::divide(const BigDecimal& divisor, int32_t scale, RoundingMode mode) const {
+	if (divisor.coeff.bit_length() == 0)
+		throw std::domain_error("BigDecimal: division by zero");
+	const int64_t e = int64_t(scale) - exp10 + divisor.exp10;
+	// dividing by a power of ten only moves the decimal point
+	if (e < 0 && divisor.coeff == BigInt(1ll))
+		return BigDecimal(DivPow10(coeff, uint64_t(-e), mode), scale);
+	BigInt num = coeff, den = divisor.coeff;
+	if (e >= 0)
+		MulPow10(num, uint64_t(e));
+	else
+		MulPow10(den, uint64_t(-e));
+	return BigDecimal(DivideRounded(num, den, mode), scale);
+}
+
+BigDecimal BigDecimal::rescale(int32_t scale, RoundingMode mode) const {
+	if (scale >= exp10) {
+		BigInt c = coeff;
+		MulPow10(c, uint64_t(int64_t(scale) - exp10));
+		return BigDecimal(c, scale);
+	}
+	return BigDecimal(DivPow10(coeff, uint64_t(int64_t(exp10) - scale), mode), scale);
+}
+
+const BigInt& BigDecimal::coefficient() const {
+	return coeff;
+}
+
+int32_t BigDecimal::scale() const {
+	return exp10;
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* COMPARISONS
+* *******************************************************************
+*/
+#pragma region comparisons
+
+int BigDecimal::Compare(const BigDecimal& other) const {
+	const BigInt zero(0ll);
+	const int signA = coeff < zero ? -1 : (coeff == zero ? 0 : 1);
+	const int signB = other.coeff < zero ? -1 : (other.coeff == zero ? 0 : 1);
+	if (signA != signB || signA == 0) return signA < signB ? -1 : (signA > signB ? 1 : 0);
+	BigInt left = coeff, right = other.coeff;
+	if (exp10 > other.exp10)
+		MulPow10(right, uint64_t(int64_t(exp10) - other.exp10));
+	else
+		MulPow10(left, uint64_t(int64_t(other.exp10) - exp10));
+	if (left == right) return 0;
+	return left < right ? -1 : 1;
+}
+
+bool BigDecimal::operator == (const BigDecimal& other) const {
+	if (exp10 == other.exp10) return coeff == other.coeff;
+	return Compare(other) == 0;
+}
+
+bool BigDecimal::operator != (const BigDecimal& other) const {
+	return !(*this == other);
+}
+
+bool BigDecimal::operator < (const BigDecimal& other) const {
+	return Compare(other) < 0;
+}
+
+bool BigDecimal::operator > (const BigDecimal& other) const {
+	return Compare(other) > 0;
+}
+
+bool BigDecimal::operator <= (const BigDecimal& other) const {
+	return Compare(other) <= 0;
+}
+
+bool BigDecimal::operator >= (const BigDecimal& other) const {
+	return Compare(other) >= 0;
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* UTILITIES
+* *******************************************************************
+*/
+#pragma region utilities
+
+int32_t BigDecimal::CheckedScale(int64_t scale) {
+	if (scale < INT32_MIN || scale > INT32_MAX)
+		throw std::out_of_range("BigDecimal: scale overflow");
+	return int32_t(scale);
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* STRING OPS
+* *******************************************************************
+*/
+#pragma region stringOps
+
+std::ostream& operator << (std::ostream& os, const BigDecimal& decimal) {
+	return os << decimal.BigDecimalToString();
+}
+
+std::string BigDecimal::BigDecimalToString() const
+{
+	std::string digits = coeff.BigIntToString();
+	std::string sign;
+	if (!digits.empty() && digits[0] == '-') {
+		sign = "-";
+		digits.erase(0, 1);
+	}
+	if (exp10 <= 0) {
+		if (digits != "0") digits.append(size_t(-int64_t(exp10)), '0');
+		return sign + digits;
+	}
+	// at least one digit before the point
+	if (digits.size() <= size_t(exp10))
+		digits.insert(0, size_t(exp10) - digits.size() + 1, '0');
+	digits.insert(digits.size() - size_t(exp10), ".");
+	return sign + digits;
+}
+
+#pragma endregion
+
+} // end of namespace bigint
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "BigInt.h"
+
+// powers of ten up to this exponent are kept in the shared cache, larger ones are built from it
+const uint32_t DECIMAL_POW10_CACHE_LIMIT = 4096;
+// rescaling by up to this many digits multiplies by single cells (10^9 at a time)
+const uint32_t DECIMAL_CELL_SCALING_DIGITS = 36;
+// digits that operator / adds to the larger scale of its operands
+const int32_t DECIMAL_DIVISION_EXTRA_DIGITS = 32;
+
+namespace bigint {
+
+// how a result is brought to a smaller scale, as in java.math.RoundingMode
+enum class RoundingMode {
+	Up,          // away from zero
+	Down,        // toward zero
+	Ceiling,     // toward +infinity
+	Floor,       // toward -infinity
+	HalfUp,      // to nearest, ties away from zero
+	HalfDown,    // to nearest, ties toward zero
+	HalfEven,    // to nearest, ties to the even neighbour (banker's rounding)
+	Unnecessary  // the result must be exact, throws std::domain_error otherwise
+};
+
+// Exact base 10 fixed point: coefficient * 10^-scale. Sums, differences and products are exact,
+// quotients and rescalings to a smaller scale round with a RoundingMode. Powers of ten come from
+// a cache shared by all threads.
+class BigDecimal {
+private:
+	BigInt coeff;
+	int32_t exp10; // the scale: digits after the decimal point, negative for trailing zeros
+public:
+	// constructors & copy
+	BigDecimal();
+	BigDecimal(int64_t);
+	BigDecimal(const BigInt& coefficient, int32_t scale = 0);
+	BigDecimal(const char* cArray); // "-123.4500", the scale is the number of fraction digits
+	BigDecimal(const BigDecimal&) = default;
+	BigDecimal& operator = (const BigDecimal&) = default;
+	// algebra ops
+	BigDecimal operator + (const BigDecimal&) const;  // scale: the larger one
+	BigDecimal operator - (const BigDecimal&) const;
+	BigDecimal operator * (const BigDecimal&) const;  // scale: the sum
+	BigDecimal operator / (const BigDecimal&) const;  // larger scale + DECIMAL_DIVISION_EXTRA_DIGITS, half even
+	void operator += (const BigDecimal&);
+	void operator -= (const BigDecimal&);
+	void operator *= (const BigDecimal&);
+	void operator /= (const BigDecimal&);
+	BigDecimal operator - () const;
+	BigDecimal operator + () const;
+	BigDecimal divide(const BigDecimal& divisor, int32_t scale, RoundingMode mode = RoundingMode::HalfEven) const;
+	BigDecimal rescale(int32_t scale, RoundingMode mode = RoundingMode::HalfEven) const;
+	const BigInt& coefficient() const;
+	int32_t scale() const;
+	// comparisons, by value: 1.0 == 1.00
+	bool operator == (const BigDecimal&) const;
+	bool operator != (const BigDecimal&) const;
+	bool operator < (const BigDecimal&) const;
+	bool operator > (const BigDecimal&) const;
+	bool operator <= (const BigDecimal&) const;
+	bool operator >= (const BigDecimal&) const;
+	// print & string ops
+	friend std::ostream& operator << (std::ostream&, const BigDecimal&);
+	std::string BigDecimalToString() const; // plain notation, all the scale digits
+private:
+	// helpers
+	int Compare(const BigDecimal& other) const;
+	static int32_t CheckedScale(int64_t scale);
+};
+
+std::ostream& operator << (std::ostream& os, const BigDecimal& decimal);
+
+} // end of namespace bigint
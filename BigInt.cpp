@@ -1,14 +1,558 @@
 #include "BigInt.h"
 #include <iostream>
-#include <deque>
 #include <vector>
+#include <algorithm>
 #include <limits>
 #include <string>
 #include <bitset>
 #include <functional>
+#include <cstring>
+#include <atomic>
+#include <random>
+#include <bit>
 
 namespace bigint {
 
+/*
+* *******************************************************************
+* CELL KERNELS
+* *******************************************************************
+*/
+#pragma region kernels
+
+namespace {
+
+// checkpoint handler of the current thread, and nesting of the staged operations running on it
+thread_local CheckpointHandler checkpointHandler = nullptr;
+thread_local void* checkpointContext = nullptr;
+thread_local int stageDepth = 0;
+
+// an operation made of stages, only the outermost one reports its progress
+class Stages {
+public:
+	Stages() : depth(++stageDepth) {}
+	~Stages() { --stageDepth; }
+	Stages(const Stages&) = delete;
+	void Checkpoint(uint64_t done, uint64_t total) const {
+		if (!checkpointHandler) return;
+		if (depth == 1)
+			checkpointHandler(checkpointContext, done, total);
+		else
+			checkpointHandler(checkpointContext, 0, 0);
+	}
+private:
+	int depth;
+};
+
+// cell products of the schoolbook division between two of its checkpoints
+const size_t DIV_CHECKPOINT_WORK = 4096;
+
+// number of cells once the most significant zero cells are dropped
+size_t NormalizedSize(const uint32_t* a, size_t n) {
+	while (n > 0 && a[n - 1] == 0) n--;
+	return n;
+}
+
+// compare two n-cells numbers, returns -1, 0 or 1
+int CompareN(const uint32_t* a, const uint32_t* b, size_t n) {
+	for (size_t i = n; i-- > 0;) {
+		if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+	}
+	return 0;
+}
+
+// r[0..rn) += a[0..an), an <= rn, returns the carry out of r
+uint32_t AddTo(uint32_t* r, size_t rn, const uint32_t* a, size_t an) {
+	uint64_t carry = 0;
+	size_t i = 0;
+	for (; i < an; i++) {
+		uint64_t sum = uint64_t(r[i]) + a[i] + carry;
+		r[i] = uint32_t(sum);
+		carry = sum >> 32;
+	}
+	for (; carry != 0 && i < rn; i++) {
+		r[i]++;
+		carry = (r[i] == 0);
+	}
+	return uint32_t(carry);
+}
+
+// r[0..rn) -= a[0..an), an <= rn, returns the borrow out of r
+uint32_t SubFrom(uint32_t* r, size_t rn, const uint32_t* a, size_t an) {
+	uint64_t borrow = 0;
+	size_t i = 0;
+	for (; i < an; i++) {
+		uint64_t diff = uint64_t(r[i]) - a[i] - borrow;
+		r[i] = uint32_t(diff);
+		borrow = (diff >> 32) & 1;
+	}
+	for (; borrow != 0 && i < rn; i++) {
+		borrow = (r[i] == 0);
+		r[i]--;
+	}
+	return uint32_t(borrow);
+}
+
+// r[0..n) = |a[0..n) - b[0..n)|, r may alias a or b
+void AbsDiffN(uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n) {
+	if (CompareN(a, b, n) < 0) std::swap(a, b);
+	uint64_t borrow = 0;
+	for (size_t i = 0; i < n; i++) {
+		uint64_t diff = uint64_t(a[i]) - b[i] - borrow;
+		r[i] = uint32_t(diff);
+		borrow = (diff >> 32) & 1;
+	}
+}
+
+// a[0..n) <<= bits (bits < 32), returns the overflown bits
+uint32_t ShiftLeftN(uint32_t* a, size_t n, unsigned bits) {
+	if (bits == 0) return 0;
+	uint32_t carry = 0;
+	for (size_t i = 0; i < n; i++) {
+		uint32_t cell = a[i];
+		a[i] = (cell << bits) | carry;
+		carry = cell >> (32 - bits);
+	}
+	return carry;
+}
+
+// a[0..n) >>= bits (bits < 32)
+void ShiftRightN(uint32_t* a, size_t n, unsigned bits) {
+	if (bits == 0) return;
+	uint32_t carry = 0;
+	for (size_t i = n; i-- > 0;) {
+		uint32_t cell = a[i];
+		a[i] = (cell >> bits) | carry;
+		carry = cell << (32 - bits);
+	}
+}
+
+// a[0..n) /= 3, the division must be exact
+void DivExactBy3(uint32_t* a, size_t n) {
+	uint64_t rem = 0;
+	for (size_t i = n; i-- > 0;) {
+		uint64_t cur = (rem << 32) | a[i];
+		a[i] = uint32_t(cur / 3);
+		rem = cur % 3;
+	}
+}
+
+// r[0..n) = ~r[0..n) + 1, two's complement
+void NegateN(uint32_t* r, size_t n) {
+	uint64_t carry = 1;
+	for (size_t i = 0; i < n; i++) {
+		uint64_t cell = uint64_t(uint32_t(~r[i])) + carry;
+		r[i] = uint32_t(cell);
+		carry = cell >> 32;
+	}
+}
+
+// r[0..n) += a[0..n) * b in a single pass, returns the carry cell
+uint32_t AddMul1(uint32_t* r, const uint32_t* a, size_t n, uint32_t b) {
+	uint64_t carry = 0;
+	for (size_t i = 0; i < n; i++) {
+		uint64_t prod = uint64_t(a[i]) * b + r[i] + carry; // can't overflow 64bit
+		r[i] = uint32_t(prod);
+		carry = prod >> 32;
+	}
+	return uint32_t(carry);
+}
+
+// r[0..n) -= a[0..n) * b in a single pass, returns the borrow cell
+uint32_t SubMul1(uint32_t* r, const uint32_t* a, size_t n, uint32_t b) {
+	uint64_t borrow = 0;
+	for (size_t i = 0; i < n; i++) {
+		uint64_t prod = uint64_t(a[i]) * b + borrow;
+		uint32_t low = uint32_t(prod);
+		borrow = (prod >> 32) + (r[i] < low);
+		r[i] -= low;
+	}
+	return uint32_t(borrow);
+}
+
+// r[0..an+bn) = a[0..an) * b[0..bn), r must not overlap the operands
+void MulBasecase(uint32_t* r, const uint32_t* a, size_t an, const uint32_t* b, size_t bn) {
+	std::fill(r, r + an, 0);
+	for (size_t i = 0; i < bn; i++)
+		r[i + an] = AddMul1(r + i, a, an, b[i]);
+}
+
+// number of leading zero bits of a non zero cell
+unsigned LeadingZeros(uint32_t cell) {
+	return unsigned(std::countl_zero(cell));
+}
+
+// the 32 bits of a[0..n) starting at bit lo, zero past the end
+uint32_t CellAt(const uint32_t* a, size_t n, size_t lo) {
+	const size_t cell = lo / 32;
+	const unsigned offset = unsigned(lo % 32);
+	if (cell >= n) return 0;
+	uint32_t result = a[cell] >> offset;
+	if (offset != 0 && cell + 1 < n) result |= a[cell + 1] << (32 - offset);
+	return result;
+}
+
+// Moller-Granlund reciprocal of a normalized cell (top bit set): floor((B^2 - 1) / d) - B, B = 2^32
+uint32_t ReciprocalCell(uint32_t d) {
+	return uint32_t(UINT64_MAX / d - (uint64_t(1) << 32));
+}
+
+// reciprocal of a normalized two cells divisor d1:d0: floor((B^3 - 1) / d) - B
+uint32_t ReciprocalPair(uint32_t d1, uint32_t d0) {
+	uint32_t v = ReciprocalCell(d1);
+	uint32_t p = d1 * v + d0;
+	if (p < d0) {
+		v--;
+		if (p >= d1) {
+			v--;
+			p -= d1;
+		}
+		p -= d1;
+	}
+	const uint64_t t = uint64_t(v) * d0;
+	const uint32_t t1 = uint32_t(t >> 32), t0 = uint32_t(t);
+	p += t1;
+	if (p < t1) {
+		v--;
+		if (p > d1 || (p == d1 && t0 >= d0)) v--;
+	}
+	return v;
+}
+
+// (u1:u0) / d for u1 < d, d normalized and v = ReciprocalCell(d): two multiplications and
+// at most two adjustments instead of a hardware division
+inline uint32_t DivRem21(uint32_t u1, uint32_t u0, uint32_t d, uint32_t v, uint32_t& r) {
+	const uint64_t qq = uint64_t(v) * u1 + ((uint64_t(u1 + 1) << 32) | u0);
+	uint32_t q = uint32_t(qq >> 32);
+	r = u0 - q * d;
+	if (r > uint32_t(qq)) {
+		q--;
+		r += d;
+	}
+	if (r >= d) {
+		q++;
+		r -= d;
+	}
+	return q;
+}
+
+// (r:u0) / d for r < d, d normalized two cells divisor and v = ReciprocalPair(d), r is updated
+inline uint32_t DivRem32(uint64_t& r, uint32_t u0, uint64_t d, uint32_t v) {
+	const uint32_t u2 = uint32_t(r >> 32), u1 = uint32_t(r);
+	const uint64_t qq = uint64_t(v) * u2 + r;
+	uint32_t q = uint32_t(qq >> 32);
+	const uint32_t r1 = u1 - q * uint32_t(d >> 32);
+	r = ((uint64_t(r1) << 32) | u0) - uint64_t(uint32_t(d)) * q - d;
+	q++;
+	if (uint32_t(r >> 32) >= uint32_t(qq)) {
+		q--;
+		r += d;
+	}
+	if (r >= d) {
+		q++;
+		r -= d;
+	}
+	return q;
+}
+
+// cell i of a[0..n) << bits (bits < 32), the dividends are normalized on the fly
+inline uint32_t ShiftedCell(const uint32_t* a, size_t i, unsigned bits) {
+	if (bits == 0) return a[i];
+	return (a[i] << bits) | (i > 0 ? a[i - 1] >> (32 - bits) : 0);
+}
+
+// q[0..n) = a[0..n) / d, returns the remainder. q may alias a, or be null for the remainder only.
+// The divisor reciprocal is computed once, each cell then costs multiplications only
+uint32_t DivRem1(uint32_t* q, const uint32_t* a, size_t n, uint32_t d) {
+	if (n == 0) return 0;
+	const unsigned shift = LeadingZeros(d);
+	const uint32_t dNorm = d << shift;
+	const uint32_t v = ReciprocalCell(dNorm);
+	uint32_t r = shift == 0 ? 0 : a[n - 1] >> (32 - shift);
+	for (size_t i = n; i-- > 0;) {
+		const uint32_t qi = DivRem21(r, ShiftedCell(a, i, shift), dNorm, v, r);
+		if (q) q[i] = qi;
+	}
+	return r >> shift;
+}
+
+// same as DivRem1 for a divisor wider than a cell, d >= 2^32
+uint64_t DivRem2(uint32_t* q, const uint32_t* a, size_t n, uint64_t d) {
+	if (n == 0) return 0;
+	const unsigned shift = LeadingZeros(uint32_t(d >> 32));
+	const uint64_t dNorm = d << shift;
+	const uint32_t v = ReciprocalPair(uint32_t(dNorm >> 32), uint32_t(dNorm));
+	uint64_t r = shift == 0 ? 0 : a[n - 1] >> (32 - shift);
+	for (size_t i = n; i-- > 0;) {
+		const uint32_t qi = DivRem32(r, ShiftedCell(a, i, shift), dNorm, v);
+		if (q) q[i] = qi;
+	}
+	return r >> shift;
+}
+
+// a[0..n) mod d
+uint32_t Mod1(const uint32_t* a, size_t n, uint32_t d) {
+	return DivRem1(nullptr, a, n, d);
+}
+
+// inverse of an odd cell modulo 2^32, each Newton step doubles the correct low bits (3 to start)
+uint32_t InverseCell(uint32_t d) {
+	uint32_t x = d;
+	for (int i = 0; i < 4; i++) x *= 2 - d * x;
+	return x;
+}
+
+// Hensel exact division, least significant cell first: q[0..an-bn+1) = a / b for an odd b that
+// divides a. Only the low cells of the running remainder that still produce quotient cells are
+// updated (Jebelean), the high half of a is never read
+void DivExactN(uint32_t* q, const uint32_t* a, size_t an, const uint32_t* b, size_t bn) {
+	const size_t qn = an - bn + 1;
+	const uint32_t inv = InverseCell(b[0]);
+	std::vector<uint32_t> u(a, a + qn);
+	for (size_t i = 0; i < qn; i++) {
+		const uint32_t qi = u[i] * inv;
+		q[i] = qi;
+		const size_t len = std::min(bn, qn - i);
+		const uint32_t borrow = SubMul1(&u[i], b, len, qi);
+		if (i + len < qn) SubFrom(&u[i + len], qn - i - len, &borrow, 1);
+	}
+}
+
+// Knuth's algorithm D (TAOCP vol. 2, 4.3.1): q[0..an-bn+1) = a / b, r[0..bn) = a % b,
+// with an >= bn >= 2 and b[bn-1] != 0
+void DivRemKnuth(uint32_t* q, uint32_t* r, const uint32_t* a, size_t an, const uint32_t* b, size_t bn) {
+	// normalize so that the top cell of the divisor has its highest bit set
+	const unsigned shift = LeadingZeros(b[bn - 1]);
+	std::vector<uint32_t> v(b, b + bn), u(a, a + an);
+	u.push_back(0);
+	ShiftLeftN(v.data(), bn, shift);
+	u[an] = ShiftLeftN(u.data(), an, shift);
+	const uint64_t vTop = v[bn - 1], vNext = v[bn - 2];
+	const Stages stages;
+	const size_t cellsPerStage = std::max<size_t>(1, DIV_CHECKPOINT_WORK / bn);
+	for (size_t j = an - bn + 1; j-- > 0;) {
+		if (j % cellsPerStage == 0) stages.Checkpoint(an - bn - j, an - bn + 1);
+		// estimate the quotient cell from the top two cells, off by at most 2
+		uint64_t num = (uint64_t(u[j + bn]) << 32) | u[j + bn - 1];
+		uint64_t qHat = num / vTop;
+		uint64_t rHat = num % vTop;
+		while (qHat > UINT32_MAX || qHat * vNext > ((rHat << 32) | u[j + bn - 2])) {
+			qHat--;
+			rHat += vTop;
+			if (rHat > UINT32_MAX) break;
+		}
+		// u[j..j+bn] -= qHat * v, add back if it went negative (rare)
+		uint32_t borrow = SubMul1(&u[j], v.data(), bn, uint32_t(qHat));
+		uint32_t top = u[j + bn];
+		u[j + bn] = top - borrow;
+		if (top < borrow) {
+			qHat--;
+			u[j + bn] += AddTo(&u[j], bn, v.data(), bn);
+		}
+		q[j] = uint32_t(qHat);
+	}
+	std::copy(u.begin(), u.begin() + bn, r);
+	ShiftRightN(r, bn, shift);
+}
+
+void SqrN(uint32_t* r, const uint32_t* a, size_t n);
+
+// r[0..2n) = a^2, every cross product a[i]*a[j] (i != j) is computed once and doubled
+void SqrBasecase(uint32_t* r, const uint32_t* a, size_t n) {
+	std::fill(r, r + 2 * n, 0);
+	// cross products above the diagonal
+	for (size_t i = 0; i + 1 < n; i++)
+		r[i + n] = AddMul1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+	// double them
+	ShiftLeftN(r, 2 * n, 1);
+	// add the diagonal squares
+	uint64_t carry = 0;
+	for (size_t i = 0; i < n; i++) {
+		uint64_t sq = uint64_t(a[i]) * a[i];
+		uint64_t lo = uint64_t(r[2 * i]) + uint32_t(sq) + carry;
+		r[2 * i] = uint32_t(lo);
+		uint64_t hi = uint64_t(r[2 * i + 1]) + (sq >> 32) + (lo >> 32);
+		r[2 * i + 1] = uint32_t(hi);
+		carry = hi >> 32;
+	}
+}
+
+// r[0..2n) = a^2 with a = a1*X + a0, X = 2^(32h):
+// a^2 = a1^2*X^2 + (a0^2 + a1^2 - (a1-a0)^2)*X + a0^2, three half size squarings
+void SqrKaratsuba(uint32_t* r, const uint32_t* a, size_t n) {
+	const Stages stages; // one per half size squaring
+	const size_t h = n / 2; // cells of a0
+	const size_t m = n - h; // cells of a1, m >= h
+	const uint32_t* a0 = a;
+	const uint32_t* a1 = a + h;
+	stages.Checkpoint(0, 3);
+	SqrN(r, a0, h);
+	stages.Checkpoint(1, 3);
+	SqrN(r + 2 * h, a1, m);
+	// |a1 - a0|, a0 zero padded to m cells
+	std::vector<uint32_t> diff(a0, a0 + h);
+	diff.resize(m, 0);
+	AbsDiffN(diff.data(), a1, diff.data(), m);
+	std::vector<uint32_t> diffSqr(2 * m);
+	stages.Checkpoint(2, 3);
+	SqrN(diffSqr.data(), diff.data(), m);
+	// middle term 2*a0*a1 = a0^2 + a1^2 - (a1-a0)^2
+	std::vector<uint32_t> mid(2 * m + 1, 0);
+	std::copy(r, r + 2 * h, mid.begin());
+	AddTo(mid.data(), mid.size(), r + 2 * h, 2 * m);
+	SubFrom(mid.data(), mid.size(), diffSqr.data(), diffSqr.size());
+	AddTo(r + h, 2 * n - h, mid.data(), NormalizedSize(mid.data(), mid.size()));
+}
+
+// r[0..2n) = a^2 with a = a2*X^2 + a1*X + a0, X = 2^(32k), evaluated in 0, 1, -1, 2, inf.
+// Since p(x)^2 has non negative coefficients c0..c4 they are interpolated without
+// ever going through a negative intermediate value:
+// c2 = (w1 + w-1)/2 - c0 - c4, c1 + c3 = (w1 - w-1)/2, c3 = (w2 - c0 - 4c2 - 16c4 - 2(c1+c3))/6
+void SqrToom3(uint32_t* r, const uint32_t* a, size_t n) {
+	const Stages stages; // one per pointwise squaring
+	const size_t k = (n + 2) / 3; // cells of a0 and a1
+	const size_t l2 = n - 2 * k;  // cells of a2
+	const uint32_t* a0 = a;
+	const uint32_t* a1 = a + k;
+	const uint32_t* a2 = a + 2 * k;
+	// evaluation (each value fits k+1 cells)
+	std::vector<uint32_t> p1(a0, a0 + k), pm1(a0, a0 + k), p2(a2, a2 + l2);
+	p1.resize(k + 1, 0); pm1.resize(k + 1, 0); p2.resize(k + 1, 0);
+	AddTo(p1.data(), k + 1, a1, k);
+	AddTo(p1.data(), k + 1, a2, l2);
+	AddTo(pm1.data(), k + 1, a2, l2);
+	std::vector<uint32_t> a1Padded(a1, a1 + k);
+	a1Padded.resize(k + 1, 0);
+	AbsDiffN(pm1.data(), pm1.data(), a1Padded.data(), k + 1);
+	ShiftLeftN(p2.data(), k + 1, 1);
+	AddTo(p2.data(), k + 1, a1, k);
+	ShiftLeftN(p2.data(), k + 1, 1);
+	AddTo(p2.data(), k + 1, a0, k);
+	// pointwise squarings
+	const size_t len = 2 * k + 3; // working length, leaves headroom for the interpolation
+	std::vector<uint32_t> w0(2 * k), w1(len, 0), wm1(len, 0), w2(len, 0), winf(2 * l2);
+	stages.Checkpoint(0, 5);
+	SqrN(w0.data(), a0, k);
+	stages.Checkpoint(1, 5);
+	SqrN(w1.data(), p1.data(), k + 1);
+	stages.Checkpoint(2, 5);
+	SqrN(wm1.data(), pm1.data(), k + 1);
+	stages.Checkpoint(3, 5);
+	SqrN(w2.data(), p2.data(), k + 1);
+	stages.Checkpoint(4, 5);
+	SqrN(winf.data(), a2, l2);
+	// c2
+	std::vector<uint32_t> c2(w1);
+	AddTo(c2.data(), len, wm1.data(), len);
+	ShiftRightN(c2.data(), len, 1);
+	SubFrom(c2.data(), len, w0.data(), w0.size());
+	SubFrom(c2.data(), len, winf.data(), winf.size());
+	// c1 + c3
+	std::vector<uint32_t> c13(w1);
+	SubFrom(c13.data(), len, wm1.data(), len);
+	ShiftRightN(c13.data(), len, 1);
+	// c3
+	std::vector<uint32_t> c3(w2), tmp(c2);
+	SubFrom(c3.data(), len, w0.data(), w0.size());
+	ShiftLeftN(tmp.data(), len, 2);
+	SubFrom(c3.data(), len, tmp.data(), len);
+	tmp.assign(len, 0);
+	std::copy(winf.begin(), winf.end(), tmp.begin());
+	ShiftLeftN(tmp.data(), len, 4);
+	SubFrom(c3.data(), len, tmp.data(), len);
+	tmp = c13;
+	ShiftLeftN(tmp.data(), len, 1);
+	SubFrom(c3.data(), len, tmp.data(), len);
+	ShiftRightN(c3.data(), len, 1);
+	DivExactBy3(c3.data(), len);
+	// c1
+	std::vector<uint32_t>& c1 = c13;
+	SubFrom(c1.data(), len, c3.data(), len);
+	// recomposition
+	std::fill(r, r + 2 * n, 0);
+	std::copy(w0.begin(), w0.end(), r);
+	std::copy(winf.begin(), winf.end(), r + 4 * k);
+	AddTo(r + k, 2 * n - k, c1.data(), NormalizedSize(c1.data(), len));
+	AddTo(r + 2 * k, 2 * n - 2 * k, c2.data(), NormalizedSize(c2.data(), len));
+	AddTo(r + 3 * k, 2 * n - 3 * k, c3.data(), NormalizedSize(c3.data(), len));
+}
+
+// r[0..2n) = a^2, picks the kernel by operand size
+void SqrN(uint32_t* r, const uint32_t* a, size_t n) {
+	if (n < SQR_KARATSUBA_THRESHOLD)
+		SqrBasecase(r, a, n);
+	else if (n < SQR_TOOM3_THRESHOLD)
+		SqrKaratsuba(r, a, n);
+	else
+		SqrToom3(r, a, n);
+}
+
+void MulN(uint32_t* r, const uint32_t* a, size_t an, const uint32_t* b, size_t bn);
+
+// r[0..an+bn) = a * b with a = a1*X + a0, b = b1*X + b0, X = 2^(32h), an >= bn > h:
+// a*b = a1*b1*X^2 + (a0*b0 + a1*b1 + (a0-a1)*(b1-b0))*X + a0*b0, three half size products
+void MulKaratsuba(uint32_t* r, const uint32_t* a, size_t an, const uint32_t* b, size_t bn) {
+	const Stages stages; // one per half size product
+	const size_t h = (an + 1) / 2;
+	const uint32_t* a0 = a;
+	const uint32_t* a1 = a + h;
+	const uint32_t* b0 = b;
+	const uint32_t* b1 = b + h;
+	stages.Checkpoint(0, 3);
+	MulN(r, a0, h, b0, h);
+	stages.Checkpoint(1, 3);
+	MulN(r + 2 * h, a1, an - h, b1, bn - h);
+	// |a0 - a1| and |b1 - b0|, high halves zero padded to h cells
+	std::vector<uint32_t> da(a1, a1 + (an - h)), db(b1, b1 + (bn - h));
+	da.resize(h, 0);
+	db.resize(h, 0);
+	const bool negative = (CompareN(a0, da.data(), h) < 0) != (CompareN(db.data(), b0, h) < 0);
+	AbsDiffN(da.data(), a0, da.data(), h);
+	AbsDiffN(db.data(), db.data(), b0, h);
+	std::vector<uint32_t> cross(2 * h);
+	stages.Checkpoint(2, 3);
+	MulN(cross.data(), da.data(), h, db.data(), h);
+	// middle term a0*b1 + a1*b0
+	std::vector<uint32_t> mid(2 * h + 1, 0);
+	std::copy(r, r + 2 * h, mid.begin());
+	AddTo(mid.data(), mid.size(), r + 2 * h, an + bn - 2 * h);
+	if (negative)
+		SubFrom(mid.data(), mid.size(), cross.data(), cross.size());
+	else
+		AddTo(mid.data(), mid.size(), cross.data(), cross.size());
+	AddTo(r + h, an + bn - h, mid.data(), NormalizedSize(mid.data(), mid.size()));
+}
+
+// r[0..an+bn) = a * b, picks the kernel by operand sizes. r must not overlap the operands
+void MulN(uint32_t* r, const uint32_t* a, size_t an, const uint32_t* b, size_t bn) {
+	if (an < bn) {
+		std::swap(a, b);
+		std::swap(an, bn);
+	}
+	if (bn < MUL_KARATSUBA_THRESHOLD) {
+		MulBasecase(r, a, an, b, bn);
+		return;
+	}
+	if (bn > (an + 1) / 2) {
+		MulKaratsuba(r, a, an, b, bn);
+		return;
+	}
+	// unbalanced: a is cut in slices of bn cells, each multiplied as a balanced product
+	std::fill(r, r + an + bn, 0);
+	std::vector<uint32_t> slice(2 * bn);
+	const Stages stages;
+	for (size_t offset = 0; offset < an; offset += bn) {
+		stages.Checkpoint(offset, an);
+		const size_t len = std::min(bn, an - offset);
+		MulN(slice.data(), a + offset, len, b, bn);
+		AddTo(r + offset, an + bn - offset, slice.data(), len + bn);
+	}
+}
+
+} // end of anonymous namespace
+
+#pragma endregion
+
 /*
 * *******************************************************************
 * CONSTRUCTORS & COPY
@@ -41,10 +585,11 @@ BigInt::BigInt(const BigInt& num) {
 	*this = num;
 }
 
-BigInt::BigInt(const char* cArray)
+BigInt::BigInt(const char* cArray) : neg(false)
 {
-	std::string s(cArray); // TODO: avoid using string
-	this->StringToBigint(s);
+	const size_t len = std::strlen(cArray);
+	value.assign(detail::LiteralCells(len), 0);
+	value.resize(detail::ParseCells(cArray, len, value.data(), neg));
 }
 
 void BigInt::operator = (const BigInt& num) {
@@ -63,6 +608,9 @@ void BigInt::operator = (const BigInt& num) {
 #pragma region algebOperations
 
 BigInt BigInt::operator + (const BigInt& other) const {
+	// zero has no sign to dispatch on
+	if (NormalizedSize(other.value.data(), other.value.size()) == 0)
+		return *this;
 	// if signs differ call sub instead
 	if (neg != other.neg)
 		return *this - (-other);
@@ -77,6 +625,7 @@ BigInt BigInt::operator + (const BigInt& other) const {
 	const uint32_t numCellsA = value.size();
 	const uint32_t numCellsB = other.value.size();
 	const uint32_t maxCells = std::max(numCellsA, numCellsB);
+	result.value.reserve(maxCells + 1);
 	// sum betw all cells
 	for (uint32_t i = 0; i < maxCells || carry != 0; i++) {
 		uint64_t a = (numCellsA > i) ? value[i] : 0;
@@ -91,18 +640,21 @@ BigInt BigInt::operator + (const BigInt& other) const {
 }
 
 BigInt BigInt::operator - (const BigInt& other) const {
+	if (NormalizedSize(other.value.data(), other.value.size()) == 0)
+		return *this;
 	// if signs differ call sum instead
 	if (neg != other.neg)
 		return *this + (-other);
-	// if left operand has less cells re-call, swapped, with !signs
+	// if left operand is smaller in modulo re-call, swapped, with !signs
+	if (this->ModuloCompareLower(other))
+		return -other - (-(*this));
 	const uint32_t nCellsA = value.size();
 	const uint32_t nCellsB = other.value.size();
-	if (nCellsA < nCellsB)
-		return -other - (-(*this));
 	// sign
 	BigInt result;
 	result.neg = neg;
 	// prepare for sub
+	result.value.reserve(nCellsA);
 	uint64_t carry = 0;
 	uint64_t b2 = 0;
 	uint32_t res32 = 0;
@@ -132,155 +684,281 @@ BigInt BigInt::operator - (const BigInt& other) const {
 }
 
 BigInt BigInt::operator * (const BigInt& other) const {
+	// a * a goes through the squaring kernels
+	if (this == &other)
+		return square();
+	const size_t nCellsA = value.size();
+	const size_t nCellsB = other.value.size();
+	if (nCellsA == 0 || nCellsB == 0)
+		return BigInt(int64_t(0));
 	// sign
 	BigInt result;
 	result.neg = neg ^ other.neg;
-	// zero pad result (dimension is sum of operand dimensions)
-	for (int i = 0; i < value.size() + other.value.size() - 1; i++) {
-		result.value.push_back(0); // TODO: is there more efficient way?
-	}
-	// product betw cells
-	uint32_t carry = 0; // stores the MSBits that result from the 32bit x 32bit product
-	for (uint32_t i = 0; i < value.size(); i++) {
-		uint64_t a = value.at(i);
-		for (uint32_t j = 0; j < other.value.size(); j++) {
-			uint64_t b = other.value.at(j);
-			uint64_t prod = a * b + carry;
-			// split in two 32 bit cells
-			result.value.at(i+j) += uint32_t(prod);
-			carry = uint32_t(prod >> 32);
-		}
-	}
-	if (carry != 0)
-		result.value.push_back(carry);
+	// product betw cells (dimension is sum of operand dimensions)
+	result.value.resize(nCellsA + nCellsB);
+	MulN(result.value.data(), value.data(), nCellsA, other.value.data(), nCellsB);
+	result.RemoveZeroCells();
+	return result;
+}
+
+BigInt BigInt::square() const {
+	const size_t nCells = value.size();
+	if (nCells == 0)
+		return BigInt(int64_t(0));
+	BigInt result; // always positive
+	result.value.resize(2 * nCells);
+	SqrN(result.value.data(), value.data(), nCells);
+	result.RemoveZeroCells();
 	return result;
 }
 
 BigInt BigInt::operator / (const BigInt& other) const {
-	BigInt result;
 	BigInt remainder;
-	result = this->DivideTemporary(other, remainder);
-	return result;
+	return this->Divide(other, remainder);
 }
 
 // Crappy division, by iterative subtraction
 BigInt BigInt::DivideTemporary(const BigInt& divisor, BigInt& remainder) const {
+	if (NormalizedSize(divisor.value.data(), divisor.value.size()) == 0)
+		throw std::domain_error("BigInt: division by zero");
 	BigInt result(0ll);
 	BigInt dividend = *this;
 
 	while (dividend >= divisor) {
 		dividend -= divisor;
 		++result;
-
-		std::cout <<
-			"\n- dividend: " << dividend <<
-			"\n- result: " << result << '\n';
+		BIGINT_TRACE("dividend: " + dividend.BigIntToBinary() + " result: " + result.BigIntToBinary());
 	}
 	remainder = dividend;
 	return result;
 }
 
-// Efficient division, not working
+// Truncates toward zero: the remainder takes the sign of the dividend. Knuth's algorithm D, or
+// Burnikel-Ziegler recursion / Newton reciprocal when both the divisor and the quotient are large
 BigInt BigInt::Divide(const BigInt& divisor, BigInt& remainder) const {
-	// save sign
-	bool resNeg = this->neg ^ divisor.neg;
-	// A dividend, B divisor, C quotient, D remainder
-	BigInt A = *this, B = divisor, C, D; // TODO: A and B are waste of memory, implement modulo comparisons
-	B.neg = false; B.neg = false;
+	const size_t nCellsA = NormalizedSize(value.data(), value.size());
+	const size_t nCellsB = NormalizedSize(divisor.value.data(), divisor.value.size());
+	if (nCellsB == 0)
+		throw std::domain_error("BigInt: division by zero");
+	// quotient and remainder are built aside, remainder may alias an operand
+	BigInt quotient, rem;
+	if (nCellsB >= DIV_BZ_THRESHOLD && nCellsA >= nCellsB + DIV_BZ_THRESHOLD)
+		DivRemLarge(*this, divisor, quotient, rem);
+	else
+		DivRemBasecase(*this, divisor, quotient, rem);
+	quotient.neg = neg ^ divisor.neg;
+	rem.neg = neg;
+	quotient.RemoveZeroCells();
+	rem.RemoveZeroCells();
+	remainder = rem;
+	return quotient;
+}
 
-	// SPECIAL CASES
+void BigInt::DivRemBasecase(const BigInt& a, const BigInt& b, BigInt& q, BigInt& r) {
+	const size_t nCellsA = NormalizedSize(a.value.data(), a.value.size());
+	const size_t nCellsB = NormalizedSize(b.value.data(), b.value.size());
+	q.neg = r.neg = false;
+	// divisor greater than dividend
+	if (nCellsA < nCellsB || (nCellsA == nCellsB && CompareN(a.value.data(), b.value.data(), nCellsA) < 0)) {
+		q.value.assign(1, 0);
+		r.value.assign(a.value.begin(), a.value.begin() + std::max<size_t>(nCellsA, 1));
+		r.RemoveZeroCells();
+		return;
+	}
+	q.value.assign(nCellsA - nCellsB + 1, 0);
+	r.value.assign(nCellsB, 0);
+	if (nCellsB == 1)
+		r.value[0] = DivRem1(q.value.data(), a.value.data(), nCellsA, b.value[0]);
+	else
+		DivRemKnuth(q.value.data(), r.value.data(), a.value.data(), nCellsA, b.value.data(), nCellsB);
+	q.RemoveZeroCells();
+	r.RemoveZeroCells();
+}
 
-	if (B == BigInt(0ll)) { // divisor == 0
-		std::cout << "ERROR: dividing for zero." << std::endl;
-		return BigInt();
+// Burnikel-Ziegler: a < b * B^n, b has n cells and its top bit set, B = 2^32. q = a / b, r = a % b
+// by two 3n/2 by n divisions, each one a recursive n/2 division plus an n/2 by n/2 product
+void BigInt::Div2n1n(const BigInt& a, const BigInt& b, size_t n, BigInt& q, BigInt& r) {
+	if (n < DIV_BZ_THRESHOLD) {
+		DivRemBasecase(a, b, q, r);
+		return;
 	}
-	if (B == BigInt(1ll)) { // divisor == 1 or -1
-		A.neg = resNeg;
-		return A;
+	if (n % 2 != 0) {
+		// pad by one cell, the quotient is unchanged and the remainder comes out shifted
+		BigInt shiftedR;
+		Div2n1n(a.ShiftedCells(1), b.ShiftedCells(1), n + 1, q, shiftedR);
+		r = shiftedR.HighCells(1);
+		return;
 	}
-	if (A < B) { // divisor greater than dividend
-		return BigInt(0ll);
+	const size_t h = n / 2;
+	BigInt qHigh, rHigh, qLow;
+	Div3n2n(a.HighCells(h), b, h, qHigh, rHigh);
+	BigInt next = rHigh.ShiftedCells(h);
+	next += a.LowCells(h);
+	Div3n2n(next, b, h, qLow, r);
+	q = qHigh.ShiftedCells(h);
+	q += qLow;
+}
+
+// a < b * B^h, b has 2h cells and its top bit set. The quotient is estimated from the top cells
+// of a and b, then corrected by at most two steps
+void BigInt::Div3n2n(const BigInt& a, const BigInt& b, size_t h, BigInt& q, BigInt& r) {
+	const BigInt b1 = b.HighCells(h);
+	const BigInt a12 = a.HighCells(h);
+	BigInt r1;
+	if (a.HighCells(2 * h).ModuloCompareLower(b1)) {
+		Div2n1n(a12, b1, h, q, r1);
 	}
-	if (A == B) { // divisor == dividend
+	else {
+		// the estimate B^h - 1, r1 = a12 - q * b1
 		BigInt one(1ll);
-		one.neg = resNeg;
-		return one;
+		q = one.ShiftedCells(h) - one;
+		r1 = a12 - b1.ShiftedCells(h) + b1;
 	}
+	r = r1.ShiftedCells(h);
+	r += a.LowCells(h);
+	r.submul(q, b.LowCells(h));
+	while (r.neg) {
+		--q;
+		r += b;
+	}
+}
 
-	// DIVISION ALGORITHM
-
-	std::cout << "A: " << A << "B: " << B;
-
-	// Copy highest part of A with length of B to D
-	D = A;
-	D.value.erase(D.value.begin(), D.value.end() - B.value.size());
-
-	// Insert element 0 to the end of integer queue of D
-	D.value.push_back(0ll);
-
-	std::cout << "D is first part of A with length B and a zero in front: " << D;
-
-	// Repeat this for all elements of A
-	for (uint32_t i = 0; i < A.value.size(); i++) {
-
-		std::cout << "Repetition " << i << " / " << (A.value.size() - 1) << "\nD: " << D << "C: " << C;
+// floor(B^2n / b) for b of n cells with its top bit set, by Newton iteration on the top half
+BigInt BigInt::Reciprocal(const BigInt& b, size_t n) {
+	BigInt one(1ll);
+	const BigInt power = one.ShiftedCells(2 * n);
+	if (n < DIV_BZ_THRESHOLD) {
+		BigInt quotient, rem;
+		DivRemBasecase(power, b, quotient, rem);
+		return quotient;
+	}
+	const size_t h = (n + 1) / 2;
+	// x ~ B^(n+h) / top ~ B^2n / b, about h correct cells
+	BigInt x = Reciprocal(b.HighCells(n - h), h).ShiftedCells(n - h);
+	// one step doubles the correct cells: x += x * (B^2n - b * x) / B^2n
+	BigInt error = power - b * x;
+	const bool negative = error.neg;
+	error.neg = false;
+	BigInt step = (x * error).HighCells(2 * n);
+	if (negative)
+		x -= step;
+	else
+		x += step;
+	// exact correction, the remainder B^2n - b * x must land in [0, b)
+	BigInt rem = power - b * x;
+	while (rem.neg) {
+		--x;
+		rem += b;
+	}
+	while (rem.ModuloCompareGreaterEqual(b)) {
+		++x;
+		rem -= b;
+	}
+	return x;
+}
 
-		// If D < B, then insert an element 0 to the lower pos of C, aka this quotient digital is 0;
-		if (D < B)
-			C.value.push_front(0);
-		// If D = B, then insert an element 1 to the lower pos of C, aka this quotient digital is 1, and do D = D - B;
-		if (D == B) {
-			C.value.push_front(1);
-			D -= B;
+// a is cut in blocks of n cells, n the divisor size, each block divided by Div2n1n, or with a
+// precomputed reciprocal once the divisor is large enough to amortize it
+void BigInt::DivRemLarge(const BigInt& a, const BigInt& b, BigInt& q, BigInt& r) {
+	const size_t n = NormalizedSize(b.value.data(), b.value.size());
+	// normalize so that the top cell of the divisor has its highest bit set
+	const unsigned shift = LeadingZeros(b.value[n - 1]);
+	BigInt divisor, dividend;
+	divisor.value.assign(b.value.begin(), b.value.begin() + n);
+	ShiftLeftN(divisor.value.data(), n, shift);
+	dividend.value.assign(a.value.begin(), a.value.end());
+	dividend.value.push_back(ShiftLeftN(dividend.value.data(), a.value.size(), shift));
+	dividend.RemoveZeroCells();
+	const size_t blocks = (dividend.value.size() + n - 1) / n;
+	const bool newton = n >= DIV_NEWTON_THRESHOLD;
+	const BigInt reciprocal = newton ? Reciprocal(divisor, n) : BigInt(0ll);
+	q.neg = false;
+	q.value.assign(blocks * n, 0);
+	BigInt rem(0ll), block, qBlock;
+	const Stages stages;
+	for (size_t i = blocks; i-- > 0;) {
+		stages.Checkpoint(blocks - 1 - i, blocks);
+		// rem < divisor, so rem * B^n + block < divisor * B^n
+		BigInt current = rem.ShiftedCells(n);
+		const size_t first = i * n;
+		const size_t last = std::min(first + n, dividend.value.size());
+		block.value.assign(dividend.value.begin() + first, dividend.value.begin() + last);
+		block.RemoveZeroCells();
+		current += block;
+		if (newton) {
+			// underestimates the quotient by at most 2
+			qBlock = (current * reciprocal).HighCells(2 * n);
+			rem = current;
+			rem.submul(qBlock, divisor);
+			while (rem.ModuloCompareGreaterEqual(divisor)) {
+				++qBlock;
+				rem -= divisor;
+			}
 		}
-		// If D > B, then try to find the quotient as follows
-		if (D > B) {
-			// copy highest two digitals of D to variable d2
-			uint64_t d2 = ((uint64_t)D.value[D.value.size() - 1] << 32) | (uint64_t)D.value[D.value.size() - 2];
-			std::cout << d2 << std::endl;
-			// copy highest one digital of B to variable b
-			uint64_t b = (uint64_t)B.value[B.value.size() - 1];
-			std::cout << b << std::endl;
-			uint64_t q = 0; // tried quotient
-			// min & max q values
-			uint64_t qMin = d2 / (b + 1); // TODO: try: uint64_t qMin = std::min(d2 / (b + 1), b + 1);
-			uint64_t qMax = std::min(d2 / b, uint64_t(UINT32_MAX));
-			std::cout << "qMax qMin: " << qMax << "   " << qMin << std::endl;
-			// BINARY SEARCH
-			// q must satisfy D<=B*(q+1) && D>=B*q
-			auto correctCondition = [&D, &B](uint64_t q) -> bool { return D <= B * BigInt(q + 1) && D >= B * BigInt(q); };
-			// if  D<B*q  then q must be higher
-			auto isHigherCondition = [&D, &B](uint64_t q) -> bool { return D < B * BigInt(q); };
-			// if  D>B*(q+1)  then q must be lower
-			auto isLowerCondition = [&D, &B](uint64_t q) -> bool { return D > B * (BigInt(q) + BigInt(1ll)); };
-			q = BinarySearch(qMin, qMax, isHigherCondition, isLowerCondition, correctCondition);
-			// q correct value should be q or q + 1
-			q = (D < B* BigInt(q + 1)) ? q : q + 1;
-			std::cout << "q: " << q << std::endl;
-			// insert it to the lower pos of C
-			C.value.push_front(q);
-			//  Subtract the product of B and the quotient from D.
-			D -= B * BigInt(q);
-			//  Temporally the highest digital of D must be 0, because
-			//  D < B, and the length of D is 1 digital more than B;
-			D.value.push_back(0ll);
+		else {
+			Div2n1n(current, divisor, n, qBlock, rem);
 		}
-
-		// Insert the next digital from A to the lower position of D
-		D.value.push_front(A.value.at(i));
-		// delete the highest element of D (it is 0)
-		D.value.pop_back();
+		std::copy(qBlock.value.begin(), qBlock.value.end(), q.value.begin() + first);
 	}
+	q.RemoveZeroCells();
+	r = rem;
+	ShiftRightN(r.value.data(), r.value.size(), shift);
+	r.RemoveZeroCells();
+}
 
-	// finally, D is the remainder.
-	remainder = D;
-	C.neg = resNeg;
-	return C;
+// Exact division, Hensel style: the quotient is produced from the least significant cell and
+// the dividend is never compared against the divisor. The result is meaningless when divisor
+// does not divide *this
+BigInt BigInt::divexact(const BigInt& divisor) const {
+	const size_t nCellsB = NormalizedSize(divisor.value.data(), divisor.value.size());
+	if (nCellsB == 0)
+		throw std::domain_error("BigInt: division by zero");
+	const size_t nCellsA = NormalizedSize(value.data(), value.size());
+	if (nCellsA < nCellsB)
+		return BigInt(0ll);
+	// large quotients are cheaper through the subquadratic division
+	if (nCellsB >= DIV_BZ_THRESHOLD && nCellsA >= nCellsB + DIV_BZ_THRESHOLD)
+		return *this / divisor;
+	// strip the common power of two, the divisor must be odd
+	size_t zeroCells = 0;
+	while (divisor.value[zeroCells] == 0) zeroCells++;
+	unsigned zeroBits = 0;
+	while (!((divisor.value[zeroCells] >> zeroBits) & 1)) zeroBits++;
+	std::vector<uint32_t> a(value.begin() + zeroCells, value.begin() + nCellsA);
+	std::vector<uint32_t> b(divisor.value.begin() + zeroCells, divisor.value.begin() + nCellsB);
+	ShiftRightN(a.data(), a.size(), zeroBits);
+	ShiftRightN(b.data(), b.size(), zeroBits);
+	const size_t an = NormalizedSize(a.data(), a.size());
+	const size_t bn = NormalizedSize(b.data(), b.size());
+	if (an < bn)
+		return BigInt(0ll);
+	BigInt quotient;
+	quotient.value.resize(an - bn + 1);
+	DivExactN(quotient.value.data(), a.data(), an, b.data(), bn);
+	quotient.neg = neg ^ divisor.neg;
+	quotient.RemoveZeroCells();
+	return quotient;
+}
+
+// Division by a machine word through a precomputed reciprocal, no hardware division per cell.
+// The quotient truncates toward zero, remainder = |*this| mod divisor
+BigInt BigInt::divmod_ui(uint64_t divisor, uint64_t& remainder) const {
+	if (divisor == 0)
+		throw std::domain_error("BigInt: division by zero");
+	BigInt quotient;
+	quotient.value.resize(value.size());
+	if (divisor <= UINT32_MAX)
+		remainder = DivRem1(quotient.value.data(), value.data(), value.size(), uint32_t(divisor));
+	else
+		remainder = DivRem2(quotient.value.data(), value.data(), value.size(), divisor);
+	quotient.neg = neg;
+	quotient.RemoveZeroCells();
+	return quotient;
 }
 
 BigInt BigInt::operator % (const BigInt& other) const {
 	BigInt remainder;
-	this->DivideTemporary(other, remainder);
+	this->Divide(other, remainder);
 	return remainder;
 }
 
@@ -289,7 +967,7 @@ BigInt BigInt::operator % (const BigInt& other) const {
 //	BigInt one(1ll);
 //	if (exponent < 0) {
 //		if (exponent == -1 && *this == one) return one;
-//		std::cout << "If exponent negative always returns 1.\n";
+//		BIGINT_TRACE("negative exponent, returning 1");
 //		return BigInt(0ll);
 //	}
 //
@@ -302,29 +980,84 @@ BigInt BigInt::operator % (const BigInt& other) const {
 
 BigInt BigInt::pow(const BigInt& exponent)
 {
-	BigInt zero(0ll);
-	BigInt one(1ll);
-	if (exponent < zero) {
-		if (exponent == -one && *this == one) return one;
-		std::cout << "If exponent negative always returns 1.\n";
-		return one;
+	if (exponent.neg) {
+		// 1 and -1 are the only integers with integer inverses
+		if (value.size() != 1 || value[0] != 1)
+			throw std::domain_error("BigInt: negative exponent in pow");
+		return BigInt(neg && exponent.test_bit(0) ? -1ll : 1ll);
 	}
 
+	// left to right binary exponentiation: a squaring per exponent bit
 	BigInt result(1ll);
-	for (BigInt i = zero; i < exponent; i += one) {
-		result *= (*this);
+	const Stages stages;
+	const size_t bits = exponent.bit_length();
+	for (size_t i = bits; i-- > 0;) {
+		stages.Checkpoint(bits - 1 - i, bits);
+		result = result.square();
+		if (exponent.test_bit(i)) result *= (*this);
 	}
 	return result;
 }
 
-void BigInt::operator += (const BigInt& other) // TODO: avoid creating a new BigInt to assign to *this (huge refactor necessary)
+// same as pow, with every step reduced modulo |modulus|: the result is in [0, |modulus|)
+BigInt BigInt::powmod(const BigInt& exponent, const BigInt& modulus) const
+{
+	if (exponent.neg)
+		throw std::domain_error("BigInt: negative exponent in powmod");
+	BigInt mod = modulus;
+	mod.neg = false;
+	BigInt base = *this % mod;
+	if (base.neg) base += mod;
+	BigInt result = BigInt(1ll) % mod;
+	const Stages stages;
+	const size_t bits = exponent.bit_length();
+	for (size_t i = bits; i-- > 0;) {
+		stages.Checkpoint(bits - 1 - i, bits);
+		result = result.square() % mod;
+		if (exponent.test_bit(i)) result = (result * base) % mod;
+	}
+	return result;
+}
+
+void BigInt::addmul(const BigInt& x, const BigInt& y)
+{
+	// rows of the product would read cells already overwritten, and past the Karatsuba
+	// threshold the separate product is cheaper than the row by row accumulation
+	if (this == &x || this == &y || std::min(x.value.size(), y.value.size()) >= MUL_KARATSUBA_THRESHOLD) {
+		*this += x * y;
+		return;
+	}
+	MulAccumulate(x, y.value.data(), y.value.size(), x.neg ^ y.neg);
+}
+
+void BigInt::submul(const BigInt& x, const BigInt& y)
+{
+	if (this == &x || this == &y || std::min(x.value.size(), y.value.size()) >= MUL_KARATSUBA_THRESHOLD) {
+		*this -= x * y;
+		return;
+	}
+	MulAccumulate(x, y.value.data(), y.value.size(), !(x.neg ^ y.neg));
+}
+
+void BigInt::addmul_1(const BigInt& x, uint32_t y)
 {
-	*this = *this + other;
+	MulAccumulate(x, &y, 1, x.neg);
+}
+
+void BigInt::submul_1(const BigInt& x, uint32_t y)
+{
+	MulAccumulate(x, &y, 1, !x.neg);
+}
+
+// in place, reuses the capacity of *this
+void BigInt::operator += (const BigInt& other)
+{
+	addmul_1(other, 1);
 }
 
 void BigInt::operator -= (const BigInt& other)
 {
-	*this = *this - other;
+	submul_1(other, 1);
 }
 
 void BigInt::operator*=(const BigInt& other)
@@ -345,7 +1078,8 @@ void BigInt::operator %= (const BigInt& other)
 // change sign
 BigInt BigInt::operator - () const {
 	BigInt res = *this;
-	res.neg = !neg;
+	if (NormalizedSize(value.data(), value.size()) != 0) // zero has no sign
+		res.neg = !neg;
 	return res;
 }
 
@@ -384,6 +1118,8 @@ bool BigInt::operator <= (const BigInt& other) const {
 		if (this->neg == true) return true;
 		else return false;
 	}
+	// both negative: the smaller modulo is the greater number
+	if (this->neg) return this->ModuloCompareGreaterEqual(other);
 	return this->ModuloCompareLowerEqual(other);
 }
 
@@ -393,6 +1129,7 @@ bool BigInt::operator >= (const BigInt& other) const {
 		if (this->neg == true) return false;
 		else return true;
 	}
+	if (this->neg) return this->ModuloCompareLowerEqual(other);
 	return this->ModuloCompareGreaterEqual(other);
 }
 
@@ -459,7 +1196,7 @@ bool BigInt::ModuloCompareLower(const BigInt& other) const {
 }
 
 bool BigInt::ModuloCompareGreater(const BigInt& other) const {
-	if (this->ModuloCompareLowerEqual(other) && this->ModuloCompareDifferent(other))
+	if (this->ModuloCompareGreaterEqual(other) && this->ModuloCompareDifferent(other))
 		return true;
 	return false;
 }
@@ -514,6 +1251,7 @@ void BigInt::ValueBitOps(const BigInt& left, const BigInt& right, T&& lambdaFunc
 	const uint32_t nCellsA = left.value.size();
 	const uint32_t nCellsB = right.value.size();
 	const uint32_t nMaxCells = std::max(nCellsA, nCellsB);
+	this->value.reserve(nMaxCells);
 	for (int i = 0; i < nMaxCells; i++) {
 		uint32_t a = (nCellsA > i) ? left.value[i] : 0;
 		uint32_t b = (nCellsB > i) ? right.value[i] : 0;
@@ -550,10 +1288,8 @@ BigInt BigInt::operator>>(const BigInt& shift) const{
 	BigInt cellShift = shift / BigInt(32);
 	uint32_t bitShift = BigInt( shift % BigInt(32) ).value.at(0); // TODO: ugly, implement cast BigInt to uint32_t
 	if (cellShift >= value.size()) return BigInt(0ll);
-	// shift whole cells (by removing LSB cells)
-	for (BigInt i(0ll); i < cellShift; ++i) {
-		result.value.pop_front();
-	}
+	// shift whole cells (by removing LSB cells), cellShift < value.size() fits a cell
+	result.value.erase(result.value.begin(), result.value.begin() + cellShift.value.at(0));
 	// shift single bits
 	uint32_t carry = 0; // stores the overflown bits of cell >> amount
 	for (uint32_t i = result.value.size() - 1; i != UINT32_MAX; i--) {
@@ -570,14 +1306,12 @@ BigInt BigInt::operator>>(const BigInt& shift) const{
 BigInt BigInt::operator<<(const BigInt& shift) const{
 	// check of how many cells and bits we need to shift
 	BigInt result = *this;
-	BigInt nCells(value.size());
 	BigInt cellShift = shift / BigInt(32);
 	BigInt bitShift = shift % BigInt(32);
-	if (cellShift >= nCells) return BigInt(0ll);
+	if (value.size() == 1 && value[0] == 0) return result;
+	if (cellShift.value.size() > 1) throw std::length_error("BigInt: shift too large");
 	// shift whole cells (by introducing zeros as LSB cells)
-	for (BigInt i(0ll); i < cellShift; ++i) {
-		result.value.push_front(0);
-	}
+	result.value.insert(result.value.begin(), cellShift.value.at(0), 0);
 	// shift single bits
 	uint32_t carry = 0; // stores the overflown bits of cell << amount
 	for (uint32_t i = 0; i < result.value.size(); i++) {
@@ -612,9 +1346,631 @@ void BigInt::operator <<= (const BigInt& shift) {
 
 
 
+size_t BigInt::bit_length() const
+{
+	const size_t nCells = NormalizedSize(value.data(), value.size());
+	if (nCells == 0) return 0;
+	return nCells * 32 - LeadingZeros(value[nCells - 1]);
+}
+
+size_t BigInt::popcount() const
+{
+	size_t count = 0;
+	for (uint32_t cell : value) count += std::popcount(cell);
+	return count;
+}
+
+size_t BigInt::countr_zero() const
+{
+	for (size_t i = 0; i < value.size(); i++) {
+		if (value[i] != 0) return i * 32 + std::countr_zero(value[i]);
+	}
+	return 0;
+}
+
+bool BigInt::test_bit(size_t i) const
+{
+	return i / 32 < value.size() && ((value[i / 32] >> (i % 32)) & 1);
+}
+
+void BigInt::set_bit(size_t i)
+{
+	if (i / 32 >= value.size()) Grow(i / 32 + 1);
+	value[i / 32] |= 1u << (i % 32);
+}
+
+void BigInt::clear_bit(size_t i)
+{
+	if (i / 32 >= value.size()) return;
+	value[i / 32] &= ~(1u << (i % 32));
+	if (i / 32 == value.size() - 1) RemoveZeroCells();
+}
+
+void BigInt::flip_bit(size_t i)
+{
+	if (i / 32 >= value.size()) Grow(i / 32 + 1);
+	value[i / 32] ^= 1u << (i % 32);
+	if (i / 32 == value.size() - 1) RemoveZeroCells();
+}
+
+BigInt BigInt::extract_bits(size_t lo, size_t len) const
+{
+	BigInt result;
+	const size_t nCells = (len + 31) / 32;
+	result.value.resize(nCells);
+	for (size_t i = 0; i < nCells; i++)
+		result.value[i] = CellAt(value.data(), value.size(), lo + 32 * i);
+	if (len % 32 != 0) result.value[nCells - 1] &= (1u << (len % 32)) - 1;
+	result.RemoveZeroCells();
+	return result;
+}
+
 #pragma endregion
 
 
+/*
+* *******************************************************************
+* NUMBER THEORY
+* *******************************************************************
+*/
+#pragma region numberTheory
+
+namespace {
+
+// primes below this bound are tabled, they drive trial division and the next_prime sieve
+const uint32_t SMALL_PRIMES_LIMIT = 1 << 16;
+// trial division in is_probable_prime only uses the primes below this bound
+const uint32_t TRIAL_DIVISION_LIMIT = 1000;
+// odd candidates sieved at once by next_prime
+const uint32_t SIEVE_WINDOW = 2048;
+
+// primes <= limit, sieve of Eratosthenes
+std::vector<uint32_t> SievePrimes(uint32_t limit) {
+	std::vector<uint32_t> primes;
+	if (limit < 2) return primes;
+	std::vector<bool> composite(size_t(limit) + 1, false);
+	for (uint64_t i = 2; i <= limit; i++) {
+		if (composite[i]) continue;
+		primes.push_back(uint32_t(i));
+		for (uint64_t j = i * i; j <= limit; j += i)
+			composite[j] = true;
+	}
+	return primes;
+}
+
+const std::vector<uint32_t>& SmallPrimes() {
+	static const std::vector<uint32_t> primes = SievePrimes(SMALL_PRIMES_LIMIT);
+	return primes;
+}
+
+// consecutive small primes whose product fits a cell: one pass over the cells of n
+// gives n mod product, from which the residues of the whole group follow
+struct PrimeGroup {
+	uint32_t product;
+	size_t first, last; // range in SmallPrimes()
+};
+
+const std::vector<PrimeGroup>& SmallPrimeGroups() {
+	static const std::vector<PrimeGroup> groups = [] {
+		std::vector<PrimeGroup> result;
+		const std::vector<uint32_t>& primes = SmallPrimes();
+		for (size_t i = 0; i < primes.size();) {
+			PrimeGroup group{ 1, i, i };
+			while (group.last < primes.size() && uint64_t(group.product) * primes[group.last] <= UINT32_MAX)
+				group.product *= primes[group.last++];
+			result.push_back(group);
+			i = group.last;
+		}
+		return result;
+	}();
+	return groups;
+}
+
+// Jacobi symbol (a/n) for odd n
+int Jacobi(uint64_t a, uint64_t n) {
+	int result = 1;
+	a %= n;
+	while (a != 0) {
+		while ((a & 1) == 0) {
+			a >>= 1;
+			if (n % 8 == 3 || n % 8 == 5) result = -result;
+		}
+		std::swap(a, n);
+		if (a % 4 == 3 && n % 4 == 3) result = -result;
+		a %= n;
+	}
+	return n == 1 ? result : 0;
+}
+
+// Jacobi symbol (d/n) for a small d and a big odd positive n
+int Jacobi(int64_t d, const BigInt& n) {
+	int result = 1;
+	uint64_t a = d < 0 ? uint64_t(-d) : uint64_t(d);
+	if (d < 0 && n.mod_ui(4) == 3) result = -result; // (-1/n)
+	while (a != 0 && (a & 1) == 0) {
+		a >>= 1;
+		uint32_t n8 = n.mod_ui(8);
+		if (n8 == 3 || n8 == 5) result = -result; // (2/n)
+	}
+	if (a == 0) return 0;
+	// quadratic reciprocity between odd a and n
+	if (a % 4 == 3 && n.mod_ui(4) == 3) result = -result;
+	return result * Jacobi(n.mod_ui(uint32_t(a)), a);
+}
+
+// x mod n in [0, n)
+BigInt Mod(const BigInt& x, const BigInt& n) {
+	BigInt r = x % n;
+	if (r < BigInt(0ll)) r += n;
+	return r;
+}
+
+// (x / 2) mod n for an odd n and a non negative x
+BigInt HalveMod(BigInt x, const BigInt& n) {
+	if (x.mod_ui(2) == 1) x += n;
+	return (x >> BigInt(1)) % n;
+}
+
+} // end of anonymous namespace
+
+// Euclid on the modulos while the divisor is wider than a machine word, binary GCD after that
+BigInt BigInt::gcd(const BigInt& a, const BigInt& b)
+{
+	BigInt x = a, y = b;
+	x.neg = y.neg = false;
+	while (y.bit_length() > 64) {
+		BigInt r = x % y;
+		x = y;
+		y = r;
+	}
+	if (y.bit_length() == 0) {
+		x.RemoveZeroCells();
+		return x;
+	}
+	uint64_t v = y.value[0] | (y.value.size() > 1 ? uint64_t(y.value[1]) << 32 : 0);
+	uint64_t u = 0;
+	x.divmod_ui(v, u);
+	if (u != 0) {
+		const int shift = std::countr_zero(u | v);
+		u >>= std::countr_zero(u);
+		do {
+			v >>= std::countr_zero(v);
+			if (u > v) std::swap(u, v);
+			v -= u;
+		} while (v != 0);
+		v = u << shift;
+	}
+	BigInt result;
+	result.value = { uint32_t(v), uint32_t(v >> 32) };
+	result.RemoveZeroCells();
+	return result;
+}
+
+uint32_t BigInt::mod_ui(uint32_t divisor) const
+{
+	if (divisor == 0)
+		throw std::domain_error("BigInt: division by zero");
+	return Mod1(value.data(), value.size(), divisor);
+}
+
+bool BigInt::IsPerfectSquare() const
+{
+	if (neg) return false;
+	// squares mod 64 only take 12 values
+	const uint32_t low = value.empty() ? 0 : value[0] & 63;
+	if (!((0x0202021202030213ull >> low) & 1)) return false;
+	// Newton iteration from above: 2^(16 cells) > sqrt(*this)
+	BigInt x = BigInt(1ll) << BigInt(int64_t(16 * value.size() + 1));
+	while (true) {
+		BigInt y = (x + *this / x) >> BigInt(1);
+		if (y >= x) break;
+		x = y;
+	}
+	return x.square() == *this;
+}
+
+// Miller-Rabin round: *this odd > 2, base in [2, *this - 2]
+bool BigInt::StrongFermatTest(const BigInt& base) const
+{
+	const BigInt one(1ll);
+	const BigInt nMinusOne = *this - one;
+	// n - 1 = d * 2^s
+	const size_t s = nMinusOne.countr_zero();
+	const BigInt d = nMinusOne >> BigInt(int64_t(s));
+	BigInt x = base.powmod(d, *this);
+	if (x == one || x == nMinusOne) return true;
+	for (size_t r = 1; r < s; r++) {
+		x = x.square() % *this;
+		if (x == nMinusOne) return true;
+		if (x == one) return false;
+	}
+	return false;
+}
+
+// strong Lucas probable prime test with Selfridge's parameters (method A), *this odd, not a square
+bool BigInt::StrongLucasTest() const
+{
+	const BigInt& n = *this;
+	// first D in 5, -7, 9, -11, ... with (D/n) = -1
+	int64_t d = 5;
+	while (true) {
+		int j = Jacobi(d, n);
+		if (j == -1) break;
+		if (j == 0 && (BigInt(d < 0 ? -d : d) != n)) return false; // shares a factor with D
+		d = d > 0 ? -(d + 2) : -(d - 2);
+	}
+	const BigInt bigD(d);
+	const BigInt q((1 - d) / 4); // P = 1
+	// n + 1 = k * 2^s
+	const BigInt nPlusOne = n + BigInt(1ll);
+	const size_t s = nPlusOne.countr_zero();
+	const BigInt k = nPlusOne >> BigInt(int64_t(s));
+	// U_k, V_k and Q^k by doubling and incrementing the index along the bits of k
+	BigInt u(1ll), v(1ll), qk = Mod(q, n);
+	for (size_t i = k.bit_length() - 1; i-- > 0;) {
+		u = (u * v) % n;
+		v = Mod(v.square() - qk - qk, n);
+		qk = qk.square() % n;
+		if (k.test_bit(i)) {
+			BigInt nextU = HalveMod(u + v, n);
+			BigInt nextV = HalveMod(Mod(bigD * u + v, n), n);
+			u = nextU;
+			v = nextV;
+			qk = Mod(qk * q, n);
+		}
+	}
+	const BigInt zero(0ll);
+	if (u == zero || v == zero) return true;
+	// V_(k*2^r) for r < s
+	for (size_t r = 1; r < s; r++) {
+		v = Mod(v.square() - qk - qk, n);
+		if (v == zero) return true;
+		qk = qk.square() % n;
+	}
+	return false;
+}
+
+// Baillie-PSW on top of trial division, *this odd and bigger than the tabled primes
+bool BigInt::PassesPrimalityTests(int rounds) const
+{
+	if (!StrongFermatTest(BigInt(2)))
+		return false;
+	if (IsPerfectSquare() || !StrongLucasTest())
+		return false;
+	// extra Miller-Rabin rounds with pseudo random bases in [2, n - 2]
+	std::mt19937 generator(value[0]);
+	const BigInt range = *this - BigInt(3);
+	for (int i = 0; i < rounds; i++) {
+		BigInt base;
+		base.value.resize(value.size());
+		for (uint32_t& cell : base.value) cell = generator();
+		base.RemoveZeroCells();
+		base = base % range + BigInt(2);
+		if (!StrongFermatTest(base))
+			return false;
+	}
+	return true;
+}
+
+bool BigInt::is_probable_prime(int rounds) const
+{
+	const size_t nCells = NormalizedSize(value.data(), value.size());
+	if (neg || nCells == 0) return false;
+	const std::vector<uint32_t>& primes = SmallPrimes();
+	if (nCells == 1 && value[0] <= primes.back())
+		return std::binary_search(primes.begin(), primes.end(), value[0]);
+	if ((value[0] & 1) == 0) return false;
+	// trial division, a cell pass per group of primes
+	for (const PrimeGroup& group : SmallPrimeGroups()) {
+		if (primes[group.first] >= TRIAL_DIVISION_LIMIT) break;
+		const uint32_t residue = mod_ui(group.product);
+		for (size_t i = group.first; i < group.last; i++)
+			if (residue % primes[i] == 0) return false;
+	}
+	return PassesPrimalityTests(rounds);
+}
+
+BigInt BigInt::next_prime() const
+{
+	const std::vector<uint32_t>& primes = SmallPrimes();
+	// answer from the table
+	if (neg || NormalizedSize(value.data(), value.size()) == 0)
+		return BigInt(2);
+	if (NormalizedSize(value.data(), value.size()) == 1 && value[0] < primes.back())
+		return BigInt(int64_t(*std::upper_bound(primes.begin(), primes.end(), value[0])));
+	// first odd candidate above *this
+	BigInt base = *this + BigInt(1ll + (value[0] & 1));
+	// residues of the window base, batched a group of primes at a time
+	std::vector<uint32_t> residues(primes.size());
+	for (const PrimeGroup& group : SmallPrimeGroups()) {
+		const uint32_t residue = base.mod_ui(group.product);
+		for (size_t i = group.first; i < group.last; i++)
+			residues[i] = residue % primes[i];
+	}
+	std::vector<bool> composite(SIEVE_WINDOW);
+	while (true) {
+		// cross out base + 2k whenever a small odd prime divides it
+		std::fill(composite.begin(), composite.end(), false);
+		for (size_t i = 1; i < primes.size(); i++) {
+			const uint32_t p = primes[i];
+			// 2k = -residue (mod p)  =>  k = (p - residue) * (p + 1) / 2 (mod p)
+			uint64_t k = (uint64_t(p - residues[i]) % p) * ((p + 1) / 2) % p;
+			for (; k < SIEVE_WINDOW; k += p)
+				composite[k] = true;
+		}
+		// survivors get the full test
+		for (uint32_t k = 0; k < SIEVE_WINDOW; k++) {
+			if (composite[k]) continue;
+			BigInt candidate = base + BigInt(int64_t(2 * k));
+			if (candidate.PassesPrimalityTests(0))
+				return candidate;
+		}
+		// slide the window
+		base += BigInt(int64_t(2 * SIEVE_WINDOW));
+		for (size_t i = 1; i < primes.size(); i++)
+			residues[i] = uint32_t((uint64_t(residues[i]) + 2 * SIEVE_WINDOW) % primes[i]);
+	}
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* COMBINATORICS
+* *******************************************************************
+*/
+#pragma region combinatorics
+
+namespace {
+
+// factorials below this are a plain loop of single cell multiplications
+const uint32_t FACTORIAL_BASECASE = 32;
+// binomial coefficients sieve the primes up to n below this bound
+const uint32_t BINOMIAL_SIEVE_LIMIT = 1 << 24;
+// and only for k^2 >= n times this: the O(n) sieve loses to the falling factorial below it
+const uint64_t BINOMIAL_SIEVE_MIN_RATIO = 16;
+
+BigInt ProductTree(const std::vector<uint32_t>& leaves, size_t first, size_t last) {
+	if (last - first == 1) return BigInt(int64_t(leaves[first]));
+	const size_t mid = first + (last - first) / 2;
+	return ProductTree(leaves, first, mid) * ProductTree(leaves, mid, last);
+}
+
+// product of factors as a balanced tree, so that the big multiplications pair operands of
+// similar size. Consecutive factors are first packed into cell sized leaves.
+BigInt ProductOf(const std::vector<uint32_t>& factors) {
+	std::vector<uint32_t> leaves;
+	uint64_t leaf = 1;
+	for (uint32_t factor : factors) {
+		if (leaf * factor > UINT32_MAX) {
+			leaves.push_back(uint32_t(leaf));
+			leaf = 1;
+		}
+		leaf *= factor;
+	}
+	leaves.push_back(uint32_t(leaf));
+	return ProductTree(leaves, 0, leaves.size());
+}
+
+// n! / (floor(n/2)!)^2 = product of p^e for the primes p <= n, e = sum over k of (n / p^k) mod 2
+BigInt PrimeSwing(uint32_t n, const std::vector<uint32_t>& primes) {
+	std::vector<uint32_t> factors;
+	for (uint32_t p : primes) {
+		if (p > n) break;
+		for (uint64_t q = n / p; q > 0; q /= p)
+			if (q & 1) factors.push_back(p);
+	}
+	return ProductOf(factors);
+}
+
+BigInt SwingFactorial(uint32_t n, const std::vector<uint32_t>& primes) {
+	if (n < FACTORIAL_BASECASE) {
+		BigInt result(1ll);
+		for (uint32_t i = 2; i <= n; i++) result *= BigInt(int64_t(i));
+		return result;
+	}
+	return SwingFactorial(n / 2, primes).square() * PrimeSwing(n, primes);
+}
+
+} // end of anonymous namespace
+
+BigInt BigInt::factorial(uint32_t n)
+{
+	return SwingFactorial(n, SievePrimes(n));
+}
+
+BigInt BigInt::binomial(uint32_t n, uint32_t k)
+{
+	if (k > n) return BigInt(0ll);
+	k = std::min(k, n - k);
+	if (n >= BINOMIAL_SIEVE_LIMIT || uint64_t(k) * k < BINOMIAL_SIEVE_MIN_RATIO * n) {
+		// n(n-1)...(n-k+1) / k!, the division is exact
+		std::vector<uint32_t> factors;
+		for (uint32_t i = 0; i < k; i++) factors.push_back(n - i);
+		return ProductOf(factors).divexact(factorial(k));
+	}
+	// Kummer: the exponent of p is the number of carries when adding k and n - k in base p
+	std::vector<uint32_t> factors;
+	for (uint32_t p : SievePrimes(n)) {
+		for (uint64_t q = p; q <= n; q *= p) {
+			if (n / q - k / q - (n - k) / q) factors.push_back(p);
+		}
+	}
+	return ProductOf(factors);
+}
+
+BigInt BigInt::primorial(uint32_t n)
+{
+	return ProductOf(SievePrimes(n));
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* MULTI-EXPONENTIATION
+* *******************************************************************
+*/
+#pragma region multiExponentiation
+
+namespace {
+
+// from this many terms multi_powmod switches from Straus to Pippenger
+const size_t PIPPENGER_THRESHOLD = 16;
+
+// base reduced in [0, modulus)
+BigInt ReduceMod(const BigInt& base, const BigInt& modulus) {
+	BigInt r = base % modulus;
+	if (r < BigInt(0ll)) r += modulus;
+	return r;
+}
+
+} // end of anonymous namespace
+
+BigInt BigInt::multi_powmod(const std::vector<BigInt>& bases, const std::vector<BigInt>& exponents, const BigInt& modulus)
+{
+	if (bases.size() != exponents.size())
+		throw std::invalid_argument("BigInt: multi_powmod needs as many exponents as bases");
+	BigInt mod = modulus;
+	mod.neg = false;
+	size_t bits = 0;
+	for (const BigInt& e : exponents) {
+		if (e.neg) throw std::domain_error("BigInt: negative exponent in multi_powmod");
+		bits = std::max(bits, e.bit_length());
+	}
+	BigInt result = BigInt(1ll) % mod;
+	const size_t terms = bases.size();
+	const Stages stages;
+	if (terms < PIPPENGER_THRESHOLD) {
+		// Straus: one table of powers per base, the squarings are shared by all the terms
+		const unsigned w = bits <= 64 ? 2 : bits <= 256 ? 3 : bits <= 1024 ? 4 : 5;
+		std::vector<std::vector<BigInt>> powers(terms);
+		for (size_t i = 0; i < terms; i++) {
+			powers[i].push_back(result);
+			powers[i].push_back(ReduceMod(bases[i], mod));
+			for (uint32_t d = 2; d < (1u << w); d++)
+				powers[i].push_back((powers[i][d - 1] * powers[i][1]) % mod);
+		}
+		const size_t windows = (bits + w - 1) / w;
+		for (size_t window = windows; window-- > 0;) {
+			stages.Checkpoint(windows - 1 - window, windows);
+			for (unsigned b = 0; b < w; b++)
+				result = result.square() % mod;
+			for (size_t i = 0; i < terms; i++) {
+				const uint32_t digit = exponents[i].Digit(window * w, w);
+				if (digit != 0) result = (result * powers[i][digit]) % mod;
+			}
+		}
+		return result;
+	}
+	// Pippenger: per window, the bases are sorted into buckets by digit and the
+	// buckets are combined as prod bucket[d]^d with two running products
+	unsigned c = 1;
+	while ((size_t(1) << (c + 1)) <= terms / 2 && c < 16) c++;
+	std::vector<BigInt> reduced;
+	for (const BigInt& base : bases) reduced.push_back(ReduceMod(base, mod));
+	const BigInt one = result;
+	std::vector<BigInt> buckets(size_t(1) << c);
+	const size_t windows = (bits + c - 1) / c;
+	for (size_t window = windows; window-- > 0;) {
+		stages.Checkpoint(windows - 1 - window, windows);
+		for (unsigned b = 0; b < c; b++)
+			result = result.square() % mod;
+		std::fill(buckets.begin(), buckets.end(), one);
+		std::vector<bool> used(buckets.size(), false);
+		for (size_t i = 0; i < terms; i++) {
+			const uint32_t digit = exponents[i].Digit(window * c, c);
+			if (digit == 0) continue;
+			buckets[digit] = used[digit] ? (buckets[digit] * reduced[i]) % mod : reduced[i];
+			used[digit] = true;
+		}
+		BigInt running = one, sum = one;
+		for (size_t d = buckets.size() - 1; d > 0; d--) {
+			if (used[d]) running = (running * buckets[d]) % mod;
+			sum = (sum * running) % mod;
+		}
+		result = (result * sum) % mod;
+	}
+	return result;
+}
+
+FixedBaseTable::FixedBaseTable(const BigInt& base, const BigInt& modulus, size_t maxExponentBits, unsigned teeth)
+	: modulus(modulus), teeth(std::max(1u, std::min(teeth, 16u)))
+{
+	this->modulus.neg = false;
+	spacing = std::max<size_t>(1, (maxExponentBits + this->teeth - 1) / this->teeth);
+	// tooth i is base^(2^(i * spacing))
+	std::vector<BigInt> tooth(this->teeth);
+	tooth[0] = ReduceMod(base, this->modulus);
+	for (unsigned i = 1; i < this->teeth; i++) {
+		tooth[i] = tooth[i - 1];
+		for (size_t k = 0; k < spacing; k++)
+			tooth[i] = tooth[i].square() % this->modulus;
+	}
+	// table[j] multiplies the teeth selected by the bits of j
+	table.resize(size_t(1) << this->teeth);
+	table[0] = BigInt(1ll) % this->modulus;
+	for (size_t j = 1; j < table.size(); j++) {
+		unsigned low = 0;
+		while (!((j >> low) & 1)) low++;
+		table[j] = (table[j & (j - 1)] * tooth[low]) % this->modulus;
+	}
+}
+
+size_t FixedBaseTable::max_exponent_bits() const
+{
+	return spacing * teeth;
+}
+
+// Lim-Lee comb: spacing squarings and at most spacing multiplications, whatever the exponent
+BigInt FixedBaseTable::pow(const BigInt& exponent) const
+{
+	if (exponent < BigInt(0ll))
+		throw std::domain_error("BigInt: negative exponent in FixedBaseTable::pow");
+	if (exponent.bit_length() > max_exponent_bits())
+		throw std::out_of_range("BigInt: exponent too big for the FixedBaseTable");
+	BigInt result = table[0];
+	for (size_t k = spacing; k-- > 0;) {
+		result = result.square() % modulus;
+		size_t j = 0;
+		for (unsigned i = 0; i < teeth; i++)
+			if (exponent.test_bit(i * spacing + k)) j |= size_t(1) << i;
+		if (j != 0) result = (result * table[j]) % modulus;
+	}
+	return result;
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* CAPACITY
+* *******************************************************************
+*/
+#pragma region capacity
+
+void BigInt::reserve(size_t bits)
+{
+	value.reserve((bits + 31) / 32);
+}
+
+void BigInt::shrink_to_fit()
+{
+	value.shrink_to_fit();
+}
+
+size_t BigInt::capacity() const
+{
+	return value.capacity() * 32;
+}
+
+size_t BigInt::memory_usage() const
+{
+	return sizeof(BigInt) + value.capacity() * sizeof(uint32_t);
+}
+
+#pragma endregion
+
 /*
 * *******************************************************************
 * UTILITIES
@@ -636,6 +1992,119 @@ void BigInt::RemoveZeroCells()
 	}
 }
 
+// *this += |x| * y (or -= if productNeg differs from the sign of *this), accumulated row by
+// row straight into the cells of *this. y must not alias *this, x may only when yn == 1.
+void BigInt::MulAccumulate(const BigInt& x, const uint32_t* y, size_t yn, bool productNeg)
+{
+	if (value.empty()) {
+		value.push_back(0);
+		neg = false;
+	}
+	const size_t xn = x.value.size();
+	if (xn == 0 || yn == 0) return;
+	if (NormalizedSize(value.data(), value.size()) == 0)
+		neg = productNeg;
+	// one extra cell so that neither the sum nor the wrapped difference can overflow
+	const size_t n = std::max(value.size(), xn + yn) + 1;
+	Grow(n);
+	const uint32_t* xCells = x.value.data(); // after the resize, x may be *this
+	if (neg == productNeg) {
+		for (size_t i = 0; i < yn; i++) {
+			uint32_t carry = AddMul1(&value[i], xCells, xn, y[i]);
+			AddTo(&value[i + xn], n - i - xn, &carry, 1);
+		}
+	}
+	else {
+		uint32_t borrowOut = 0;
+		for (size_t i = 0; i < yn; i++) {
+			uint32_t borrow = SubMul1(&value[i], xCells, xn, y[i]);
+			borrowOut += SubFrom(&value[i + xn], n - i - xn, &borrow, 1);
+		}
+		// product was bigger than *this: cells hold 2^(32n) - |result|
+		if (borrowOut != 0) {
+			NegateN(value.data(), n);
+			neg = !neg;
+		}
+	}
+	RemoveZeroCells();
+}
+
+// resizes to cells, growing the capacity geometrically so that
+// accumulation loops only reallocate a logarithmic number of times
+void BigInt::Grow(size_t cells)
+{
+	if (cells > value.capacity())
+		value.reserve(std::max(cells, value.capacity() + value.capacity() / 2));
+	value.resize(cells, 0);
+}
+
+BigInt BigInt::LowCells(size_t n) const {
+	BigInt result;
+	result.value.assign(value.begin(), value.begin() + std::min(n, value.size()));
+	result.RemoveZeroCells();
+	return result;
+}
+
+BigInt BigInt::HighCells(size_t n) const {
+	BigInt result;
+	if (n < value.size())
+		result.value.assign(value.begin() + n, value.end());
+	result.RemoveZeroCells();
+	return result;
+}
+
+BigInt BigInt::ShiftedCells(size_t n) const {
+	BigInt result;
+	if (NormalizedSize(value.data(), value.size()) != 0) {
+		result.value.assign(n, 0);
+		result.value.insert(result.value.end(), value.begin(), value.end());
+	}
+	result.RemoveZeroCells();
+	return result;
+}
+
+void SetCheckpointHandler(CheckpointHandler handler, void* context)
+{
+	checkpointHandler = handler;
+	checkpointContext = context;
+}
+
+CheckpointState GetCheckpointState()
+{
+	return CheckpointState{ checkpointHandler, checkpointContext, stageDepth };
+}
+
+void SetCheckpointState(const CheckpointState& state)
+{
+	checkpointHandler = state.handler;
+	checkpointContext = state.context;
+	stageDepth = state.stageDepth;
+}
+
+#ifdef BIGINT_ENABLE_TRACE
+namespace {
+std::atomic<TraceCallback> traceCallback{ nullptr };
+}
+
+void SetTraceCallback(TraceCallback callback)
+{
+	traceCallback.store(callback);
+}
+
+void Trace(const char* function, const std::string& message)
+{
+	if (TraceCallback callback = traceCallback.load())
+		callback(function, message);
+}
+#endif
+
+// the w (<= 32) bits of the modulo starting at bit lo
+uint32_t BigInt::Digit(size_t lo, unsigned w) const
+{
+	const uint32_t cell = CellAt(value.data(), value.size(), lo);
+	return w >= 32 ? cell : cell & ((1u << w) - 1);
+}
+
 uint64_t BinarySearch(
 	uint64_t begin, 
 	uint64_t end,
@@ -643,15 +2112,19 @@ uint64_t BinarySearch(
 	const std::function<bool(uint64_t q)>& isLower,
 	const std::function<bool(uint64_t q)>& isCorrect)
 {
-	uint64_t result;
+	uint64_t result = begin;
 	while (begin <= end) {
 		result = (begin + end) / 2; // middle
-		std::cout << result << std::endl;
+		BIGINT_TRACE("probe: " + std::to_string(result));
 		if (isCorrect(result)) return result;
 		else if (isHigher(result)) end = result - 1;
 		else if (isLower(result)) begin = result + 1;
-		else std::cout << "Binary search is failing ... ";
+		else {
+			BIGINT_TRACE("binary search is failing");
+			break;
+		}
 	}
+	return result;
 }
 #pragma endregion
 
@@ -669,26 +2142,21 @@ std::ostream& operator << (std::ostream& os, const BigInt& bigint) {
 std::string BigInt::BigIntToString() const
 {
 	if (value.size() == 0) return "Empty";
+	// 9 decimal digits per division by 10^9, least significant chunk first
+	std::vector<uint32_t> cells(value);
+	size_t n = NormalizedSize(cells.data(), cells.size());
+	if (n == 0) return "0";
+	std::vector<uint32_t> chunks;
+	while (n > 0) {
+		chunks.push_back(DivRem1(cells.data(), cells.data(), n, 1000000000u));
+		n = NormalizedSize(cells.data(), n);
+	}
 	std::string result = neg ? "-" : "";
-
-	//int cellIndex = 0;
-	for (auto iter = value.rbegin(); iter != value.rend(); iter++) {
-		uint32_t cellValue = *iter;
-		//printf("- cell %02d --> %010u\n", (int)cellIndex, cellValue);
-		std::string s = std::to_string(cellValue);
-		
-		// cell zero-padding
-		std::string zerostr = "0";
-		//if (iter != value.rbegin()) {
-			int numZeros = CELL_NUM_DIGITS - s.size();
-			for (int i = 0; i < numZeros; i++) {
-				s = zerostr + s; // TODO: refactor
-			}
-		//}
-
-		result.append(s);
-		result.append(".");
-		//cellIndex++;
+	result += std::to_string(chunks.back());
+	for (size_t i = chunks.size() - 1; i-- > 0;) {
+		std::string s = std::to_string(chunks[i]);
+		result.append(9 - s.size(), '0'); // chunk zero-padding
+		result += s;
 	}
 	return result;
 }
@@ -711,20 +2179,8 @@ std::string BigInt::BigIntToBinary() const
 
 void BigInt::StringToBigint(const std::string& s)
 {
-	this->value.clear();
-	uint32_t signOffset = (s[0] == '-' || s[0] == '+') ? 1 : 0;
-	// for each character, multiply it for 10^position and sum it to this bigint
-	for (int64_t i = s.size() - 1; i >= signOffset; i--) {
-		uint32_t character = uint32_t(s[i]) - 48;
-		BigInt charValue = BigInt(character) * BigInt(10).pow(s.size() - 1 - i);
-		*this += charValue;
-	}
-	// sign
-	this->neg = false;
-	if (signOffset) {
-		if (s[0] == '-') this->neg = true;
-		if (s[0] == '+') this->neg = false;
-	}
+	value.assign(detail::LiteralCells(s.size()), 0);
+	value.resize(detail::ParseCells(s.data(), s.size(), value.data(), neg));
 }
 
 #pragma endregion
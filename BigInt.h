@@ -1,18 +1,138 @@
 #pragma once
 #include <cstdlib>
 #include <iostream>
-#include <deque>
+#include <vector>
 #include <limits>
 #include <functional>
+#include <stdexcept>
+#include <string>
 
 const int CELL_NUM_DIGITS = 10;
 const uint32_t CELL_MAX = UINT32_MAX;
+// number of cells from which squaring switches to Karatsuba and Toom-3
+const size_t SQR_KARATSUBA_THRESHOLD = 48;
+const size_t SQR_TOOM3_THRESHOLD = 160;
+// number of cells of the smaller operand from which multiplication switches to Karatsuba
+const size_t MUL_KARATSUBA_THRESHOLD = 32;
+// divisor cells from which division switches to Burnikel-Ziegler recursion, then to a Newton reciprocal
+const size_t DIV_BZ_THRESHOLD = 64;
+const size_t DIV_NEWTON_THRESHOLD = 2048;
 
 namespace bigint {
 
+// Diagnostics: build with BIGINT_ENABLE_TRACE defined to route the internal trace messages of the
+// arithmetic to the callback installed with SetTraceCallback. Otherwise BIGINT_TRACE expands to
+// nothing and its message argument is never evaluated.
+#ifdef BIGINT_ENABLE_TRACE
+using TraceCallback = void (*)(const char* function, const std::string& message);
+void SetTraceCallback(TraceCallback callback);
+void Trace(const char* function, const std::string& message);
+#define BIGINT_TRACE(message) ::bigint::Trace(__func__, (message))
+#else
+#define BIGINT_TRACE(message) ((void)0)
+#endif
+
+// Cooperative cancellation and progress: the long running algorithms (pow, powmod, multi_powmod,
+// divisions by more than one cell, Karatsuba and Toom-3 products) call the handler installed for
+// the calling thread between their stages. done/total is the progress of the outermost operation, 0/0 at the inner checkpoints.
+// The handler aborts the operation by throwing.
+using CheckpointHandler = void (*)(void* context, uint64_t done, uint64_t total);
+void SetCheckpointHandler(CheckpointHandler handler, void* context = nullptr); // current thread only
+// handler, context and staged operation nesting of the current thread, saved and restored
+// around a nested handler
+struct CheckpointState {
+	CheckpointHandler handler = nullptr;
+	void* context = nullptr;
+	int stageDepth = 0;
+};
+CheckpointState GetCheckpointState();
+void SetCheckpointState(const CheckpointState& state);
+
+// cells of a number parsed at compile time, see ParseBigInt and operator"" _big
+template<size_t N>
+struct BigIntLiteral {
+	uint32_t cells[N] = {};
+	size_t size = 0; // significant cells
+	bool neg = false;
+};
+
+namespace detail {
+
+// cells that can hold a number written with chars characters (at most 4 bits per digit)
+constexpr size_t LiteralCells(size_t chars) { return chars / 8 + 1; }
+
+// cells[0..size) = cells * mul + add, returns the new size
+constexpr size_t MulAddCell(uint32_t* cells, size_t size, uint32_t mul, uint32_t add) {
+	uint64_t carry = add;
+	for (size_t i = 0; i < size; i++) {
+		uint64_t cur = uint64_t(cells[i]) * mul + carry;
+		cells[i] = uint32_t(cur);
+		carry = cur >> 32;
+	}
+	if (carry != 0) cells[size++] = uint32_t(carry);
+	return size;
+}
+
+// Parses an optionally signed decimal, or 0x prefixed hexadecimal, number. With octal set a
+// leading 0 followed by more digits makes it octal, as in C++ literals. Digit separators (') are
+// skipped. cells must hold LiteralCells(len) cells, returns the number of significant cells.
+constexpr size_t ParseCells(const char* s, size_t len, uint32_t* cells, bool& neg, bool octal = false) {
+	size_t pos = 0;
+	neg = false;
+	if (pos < len && (s[pos] == '-' || s[pos] == '+')) {
+		neg = (s[pos] == '-');
+		pos++;
+	}
+	bool hex = false;
+	if (pos + 1 < len && s[pos] == '0' && (s[pos + 1] == 'x' || s[pos + 1] == 'X')) {
+		hex = true;
+		pos += 2;
+	}
+	octal = octal && !hex && pos + 1 < len && s[pos] == '0';
+	for (size_t i = 0; i < LiteralCells(len); i++) cells[i] = 0;
+	// digits are gathered in chunks that fit a cell, then merged with a single cell pass
+	const uint32_t base = hex ? 16 : (octal ? 8 : 10);
+	const uint32_t chunkMax = hex ? (1u << 28) : (octal ? (1u << 30) : 1000000000u);
+	uint32_t chunk = 0, chunkMul = 1;
+	size_t size = 1, digits = 0;
+	for (; pos < len; pos++) {
+		const char c = s[pos];
+		if (c == '\'') continue;
+		uint32_t digit = base;
+		if (c >= '0' && c <= '9') digit = uint32_t(c - '0');
+		else if (c >= 'a' && c <= 'f') digit = uint32_t(c - 'a' + 10);
+		else if (c >= 'A' && c <= 'F') digit = uint32_t(c - 'A' + 10);
+		if (digit >= base) throw std::invalid_argument("BigInt: invalid digit");
+		chunk = chunk * base + digit;
+		chunkMul *= base;
+		digits++;
+		if (chunkMul == chunkMax) {
+			size = MulAddCell(cells, size, chunkMul, chunk);
+			chunk = 0;
+			chunkMul = 1;
+		}
+	}
+	if (digits == 0) throw std::invalid_argument("BigInt: no digits");
+	if (chunkMul > 1) size = MulAddCell(cells, size, chunkMul, chunk);
+	while (size > 1 && cells[size - 1] == 0) size--;
+	if (size == 1 && cells[0] == 0) neg = false;
+	return size;
+}
+
+} // end of namespace detail
+
+// parses a string literal at compile time:  constexpr auto p = ParseBigInt("0xFFFFFFFF00000001");
+// octal as in ParseCells, for the _big literals
+template<size_t N>
+constexpr BigIntLiteral<detail::LiteralCells(N)> ParseBigInt(const char (&s)[N], bool octal = false) {
+	BigIntLiteral<detail::LiteralCells(N)> lit{};
+	lit.size = detail::ParseCells(s, N - 1, lit.cells, lit.neg, octal);
+	return lit;
+}
+
 class BigInt {
 private:
-	std::deque<uint32_t> value;
+	std::vector<uint32_t> value; // cells, least significant first
 	bool neg; // is negative
 public:
 	// constructors & copy
@@ -20,6 +140,8 @@ public:
 	BigInt(int64_t);
 	BigInt(const BigInt&);
 	BigInt(const char* cArray);
+	template<size_t N>
+	BigInt(const BigIntLiteral<N>& lit) : value(lit.cells, lit.cells + lit.size), neg(lit.neg) {} // copies the cells, no parsing
 	void operator = (const BigInt&);
 	// algebra ops
 	BigInt operator + (const BigInt&) const;
@@ -35,8 +157,30 @@ public:
 	BigInt operator - () const;
 	BigInt operator + () const;
 	BigInt pow(const BigInt&);
+	BigInt powmod(const BigInt& exponent, const BigInt& modulus) const;
+	BigInt square() const;
+	// fused multiply-accumulate, accumulated row by row without a temporary product, except when
+	// *this aliases x or y or both operands have MUL_KARATSUBA_THRESHOLD cells: addmul and submul
+	// then build x * y (Karatsuba) and add or subtract it
+	void addmul(const BigInt& x, const BigInt& y);   // *this += x * y
+	void submul(const BigInt& x, const BigInt& y);   // *this -= x * y
+	void addmul_1(const BigInt& x, uint32_t y);      // *this += x * y, single pass
+	void submul_1(const BigInt& x, uint32_t y);      // *this -= x * y, single pass
 	BigInt Divide(const BigInt& divisor, BigInt& remainder) const;
 	BigInt DivideTemporary(const BigInt& divisor, BigInt& remainder) const;
+	BigInt divexact(const BigInt& divisor) const;                   // *this / divisor, divisor must divide *this
+	BigInt divmod_ui(uint64_t divisor, uint64_t& remainder) const;  // remainder = |*this| mod divisor
+	// number theory
+	uint32_t mod_ui(uint32_t divisor) const;         // |*this| mod divisor
+	bool is_probable_prime(int rounds = 0) const;    // Baillie-PSW, plus rounds random base Miller-Rabin
+	BigInt next_prime() const;                       // smallest probable prime > *this
+	static BigInt gcd(const BigInt& a, const BigInt& b); // nonnegative, gcd(0, 0) = 0
+	// prod bases[i]^exponents[i] mod |modulus|, sharing the squarings (Straus, Pippenger for many terms)
+	static BigInt multi_powmod(const std::vector<BigInt>& bases, const std::vector<BigInt>& exponents, const BigInt& modulus);
+	// combinatorics, built on balanced product trees
+	static BigInt factorial(uint32_t n);                  // prime swing: n! = ((n/2)!)^2 * swing(n)
+	static BigInt binomial(uint32_t n, uint32_t k);
+	static BigInt primorial(uint32_t n);                  // product of the primes <= n
 	// comparisons
 	bool operator == (const BigInt&) const;
 	bool operator != (const BigInt&) const;
@@ -67,6 +211,20 @@ public:
 	void operator ^= (const BigInt&);
 	void operator >>= (const BigInt&);
 	void operator <<= (const BigInt&);
+	// bit queries and single bit ops, on the modulo (the sign is untouched), no temporaries
+	size_t bit_length() const;                        // 0 for zero
+	size_t popcount() const;
+	size_t countr_zero() const;                       // trailing zero bits, 0 for zero
+	bool test_bit(size_t i) const;
+	void set_bit(size_t i);
+	void clear_bit(size_t i);
+	void flip_bit(size_t i);
+	BigInt extract_bits(size_t lo, size_t len) const; // bits [lo, lo + len), nonnegative
+	// capacity
+	void reserve(size_t bits);    // pre-size the storage for values up to bits wide
+	void shrink_to_fit();
+	size_t capacity() const;      // in bits
+	size_t memory_usage() const;  // bytes held, object plus cells storage (allocator overhead excluded)
 	// print & string ops
 	friend std::ostream& operator << (std::ostream&, const BigInt&);
 	std::string BigIntToString() const;
@@ -75,6 +233,24 @@ public:
 private:
 	// helpers
 	void RemoveZeroCells();
+	friend class FixedBaseTable;
+	void Grow(size_t cells);
+	uint32_t Digit(size_t lo, unsigned w) const;
+	bool IsPerfectSquare() const;
+	bool StrongFermatTest(const BigInt& base) const;
+	bool StrongLucasTest() const;
+	bool PassesPrimalityTests(int rounds) const;
+	void MulAccumulate(const BigInt& x, const uint32_t* y, size_t yn, bool productNeg);
+	// whole cell views of the modulo: low n cells, cells from n up (>> 32n), shifted up by n cells
+	BigInt LowCells(size_t n) const;
+	BigInt HighCells(size_t n) const;
+	BigInt ShiftedCells(size_t n) const;
+	// division of the modulos, q and r nonnegative and distinct from the operands
+	static void DivRemBasecase(const BigInt& a, const BigInt& b, BigInt& q, BigInt& r);
+	static void DivRemLarge(const BigInt& a, const BigInt& b, BigInt& q, BigInt& r);
+	static void Div2n1n(const BigInt& a, const BigInt& b, size_t n, BigInt& q, BigInt& r);
+	static void Div3n2n(const BigInt& a, const BigInt& b, size_t h, BigInt& q, BigInt& r);
+	static BigInt Reciprocal(const BigInt& b, size_t n);
 	template<typename T>void ValueBitOps(const BigInt& left, const BigInt& right, T&& lambdaFunc);
 public:
 
@@ -82,6 +258,34 @@ public:
 
 std::ostream& operator << (std::ostream& os, const BigInt& bigint);
 
+// Precomputed powers of a fixed base modulo a fixed modulus (Lim-Lee comb), for raising the same
+// base to many exponents. Holds 2^teeth values; pow costs about maxExponentBits/teeth squarings
+// and as many multiplications at most.
+class FixedBaseTable {
+public:
+	FixedBaseTable(const BigInt& base, const BigInt& modulus, size_t maxExponentBits, unsigned teeth = 6);
+	BigInt pow(const BigInt& exponent) const; // base^exponent mod |modulus|, exponent < 2^max_exponent_bits()
+	size_t max_exponent_bits() const;
+private:
+	BigInt modulus;
+	unsigned teeth;
+	size_t spacing; // bits between two teeth of the comb
+	std::vector<BigInt> table;
+};
+
+namespace literals {
+
+// 123_big, 0xFFFF'FFFF_big, 0777_big (octal): parsed at compile time, the cells are a constant
+// of the binary
+template<char... chars>
+BigInt operator"" _big() {
+	static constexpr char s[] = { chars..., '\0' };
+	static constexpr auto lit = ParseBigInt(s, true);
+	return BigInt(lit);
+}
+
+} // end of namespace literals
+
 uint64_t BinarySearch(uint64_t begin, uint64_t end, const std::function<bool(uint64_t)>& isHigher, 
 	const std::function<bool(uint64_t)>& isLower, const std::function<bool(uint64_t)>& isCorrect);
 
@@ -5,6 +5,10 @@
 #include <string>
 #include <assert.h>
 #include "BigInt.h"
+#include "BigRational.h"
+#include "BigDecimal.h"
+#include "RnsBigInt.h"
+#include "BigIntAsync.h"
 
 using namespace bigint;
 
@@ -19,13 +23,16 @@ void CheckConstructors() {
 	BigInt b("4294967296");
 	assert(a == b);
 }
-void CheckBigIntToString() { // NOT WORKING [TODO] BigIntToString yet to implement
+void CheckBigIntToString() {
     // string -> bigint
 	BigInt a("-122333444455555");
     // bigint -> string
 	std::string str = a.BigIntToString();
 	BigInt b( str.c_str() ); // c_str -> string to char*
     assert(a == b);
+	assert(str == "-122333444455555");
+	assert(BigInt(0ll).BigIntToString() == "0");
+	assert(BigInt(10).pow(BigInt(40)).BigIntToString() == "1" + std::string(40, '0'));
 }
 void CheckSum() {
 	BigInt        a(uint64_t(UINT32_MAX) - 100);
@@ -87,6 +94,23 @@ void CheckBitOps() {
 	res = a ^ b;
 	assert(res == expectedXor);
 }
+void CheckSingleBits() {
+	BigInt a(0ll);
+	a.set_bit(100);
+	a.set_bit(3);
+	assert(a == (BigInt(1) << BigInt(100)) + BigInt(8));
+	assert(a.bit_length() == 101 && a.popcount() == 2 && a.countr_zero() == 3);
+	assert(a.test_bit(100) && !a.test_bit(99) && !a.test_bit(5000));
+	a.flip_bit(3);
+	assert(a.countr_zero() == 100);
+	a.clear_bit(100);
+	assert(a == BigInt(0ll) && a.bit_length() == 0 && a.popcount() == 0 && a.countr_zero() == 0);
+	BigInt b = -(BigInt(0xF0F0F0F0F0F0F0F) << BigInt(40));
+	assert(b.extract_bits(44, 12) == BigInt(0x0F0) && b.extract_bits(40, 200) == -b >> BigInt(40));
+	assert(b.popcount() == 32 && b.countr_zero() == 40 && b.bit_length() == 100);
+	b.flip_bit(99);
+	assert(b == -(BigInt(0x70F0F0F0F0F0F0F) << BigInt(40)));
+}
 void CheckBitShifts() {
 	BigInt a(9000000000);
 	std::cout << "A:" << a << '\n';
@@ -95,7 +119,7 @@ void CheckBitShifts() {
 	std::cout << "A shifted right:" << b << '\n';
 	std::cout << "A shifted left:" << c << '\n';
 }
-void CheckTrueDiv() { // NOT WORKING [TODO] make division work
+void CheckTrueDiv() {
 	BigInt a("500000000000000000000000000000000000000000");
 	BigInt b("5000000000000000000000");
 	BigInt expected("100000000000000000000");
@@ -112,6 +136,380 @@ void CheckTrueDiv() { // NOT WORKING [TODO] make division work
 	assert(res == expected);
 	assert(modulo == BigInt(0ll));
 }
+void CheckSquare() {
+	// grow a number through every squaring kernel (basecase, Karatsuba, Toom-3)
+	BigInt a(int64_t(0x123456789abcdef));
+	BigInt factor(int64_t(0x7fffffffffffffe7));
+	for (int i = 0; i < 200; i++) {
+		a = a * factor + BigInt(i);
+		BigInt copy(a);
+		assert(a.square() == a * copy);
+		assert(a * a == a * copy);
+	}
+	assert((-a).square() == a.square());
+	assert(BigInt(3).pow(BigInt(5)) == BigInt(243));
+	bool thrown = false;
+	try { BigInt(2).pow(BigInt(-1)); } catch (const std::domain_error&) { thrown = true; }
+	assert(thrown);
+	assert(BigInt(1).pow(BigInt(-1)) == BigInt(1));
+	assert(BigInt(-1).pow(BigInt(-3)) == BigInt(-1) && BigInt(-1).pow(BigInt(-4)) == BigInt(1));
+}
+void CheckMulAccumulate() {
+	BigInt x("-123456789012345678901234567890");
+	BigInt y("98765432109876543210");
+	BigInt accs[] = { BigInt(int64_t(0)), BigInt(7), BigInt(-7), x * y, -(x * y), x * y * BigInt(3) };
+	for (const BigInt& start : accs) {
+		BigInt acc = start;
+		acc.addmul(x, y);
+		assert(acc == start + x * y);
+		acc = start;
+		acc.submul(x, y);
+		assert(acc == start - x * y);
+		acc = start;
+		acc.addmul_1(x, 4000000000u);
+		assert(acc == start + x * BigInt(4000000000));
+		acc = start;
+		acc.submul_1(y, 4000000000u);
+		assert(acc == start - y * BigInt(4000000000));
+	}
+	// accumulating into one of the operands
+	BigInt acc = y;
+	acc.addmul_1(acc, 3);
+	assert(acc == y * BigInt(4));
+	acc.addmul(acc, y);
+	assert(acc == y * BigInt(4) + y * BigInt(4) * y);
+}
+void CheckCapacity() {
+	BigInt acc(int64_t(0));
+	acc.reserve(4096);
+	const size_t reserved = acc.capacity();
+	assert(reserved >= 4096);
+	assert(acc.memory_usage() >= sizeof(BigInt) + 4096 / 8);
+	// accumulating within the reserved bits must not reallocate
+	BigInt term("340282366920938463463374607431768211455"); // 2^128 - 1
+	for (int i = 0; i < 100; i++) {
+		acc += term;
+		acc.addmul(term, term);
+	}
+	assert(acc.capacity() == reserved);
+	acc.shrink_to_fit();
+	assert(acc.capacity() < reserved);
+	assert(acc.memory_usage() < sizeof(BigInt) + reserved / 8);
+}
+void CheckLiterals() {
+	using namespace bigint::literals;
+	// parsed by the compiler
+	static constexpr auto prime = ParseBigInt("0xFFFFFFFF00000001");
+	static_assert(prime.size == 2 && prime.cells[0] == 1 && prime.cells[1] == 0xFFFFFFFF, "hex literal");
+	static_assert(ParseBigInt("-1'000'000'000'000").neg, "signed literal");
+	static_assert(!ParseBigInt("-0").neg, "negative zero");
+	assert(BigInt(prime) == BigInt(int64_t(0xFFFFFFFF)) * BigInt(int64_t(1) << 32) + BigInt(1));
+	assert(500000000000000000000000000000000000000000_big == BigInt(5) * BigInt(10).pow(BigInt(41)));
+	assert(0xDEAD'BEEF_big == BigInt(int64_t(0xDEADBEEF)));
+	assert(-42_big == BigInt(-42));
+	// a leading zero means octal, as for the built-in literals
+	assert(010_big == BigInt(010) && 0_big == BigInt(0ll) && 0'777'777'777'777_big == BigInt(0777777777777));
+	static_assert(ParseBigInt("-017", true).cells[0] == 15 && ParseBigInt("017").cells[0] == 17, "octal literal");
+	// runtime parsing shares the same code
+	assert(BigInt("500000000000000000000000000000000000000000") == 500000000000000000000000000000000000000000_big);
+	assert(BigInt("-0x10") == BigInt(-16));
+}
+void CheckDivisionByZero() {
+	BigInt a("123456789012345678901234567890");
+	BigInt zero(int64_t(0));
+	BigInt remainder;
+	bool thrown = false;
+	try { a / zero; } catch (const std::domain_error&) { thrown = true; }
+	assert(thrown);
+	thrown = false;
+	try { a.Divide(zero, remainder); } catch (const std::domain_error&) { thrown = true; }
+	assert(thrown);
+}
+void CheckSigns() {
+	// negative operands compare by the reversed modulo
+	assert(BigInt(-5) < BigInt(-3) && BigInt(-3) > BigInt(-5));
+	assert(BigInt(-5) <= BigInt(-5) && !(BigInt(-3) <= BigInt(-5)));
+	// |a| < |b| with the same number of cells
+	assert(BigInt(3) - BigInt(5) == BigInt(-2));
+	assert(BigInt(-3) - BigInt(-5) == BigInt(2));
+	// zero has no sign
+	assert(-BigInt(0ll) == BigInt(0ll));
+	assert(BigInt(0ll) - BigInt(0ll) == BigInt(0ll));
+	// shifts past the operand width
+	assert((BigInt(1) << BigInt(64)) == BigInt(4294967296) * BigInt(4294967296));
+	assert((BigInt(0ll) << BigInt(32)) == BigInt(0ll));
+	assert((BigInt(0ll) << BigInt(32)) - BigInt(3) == BigInt(-3));
+}
+void CheckPrimes() {
+	// Mersenne primes and their neighbours
+	BigInt m127 = BigInt(2).pow(BigInt(127)) - BigInt(1);
+	BigInt m89 = BigInt(2).pow(BigInt(89)) - BigInt(1);
+	assert(m127.is_probable_prime());
+	assert(m89.is_probable_prime(5));
+	assert(!(m127 * m89).is_probable_prime());
+	assert(!(m127 + BigInt(2)).is_probable_prime());
+	// Carmichael number, strong pseudoprimes to base 2, strong Lucas pseudoprime, square of a prime
+	assert(!BigInt(561).is_probable_prime());
+	assert(!BigInt(3215031751).is_probable_prime());
+	assert(!BigInt("3825123056546413051").is_probable_prime());
+	assert(!BigInt(5459).is_probable_prime());
+	assert(!m89.square().is_probable_prime());
+	assert(BigInt(65537).is_probable_prime());
+	assert(!BigInt(-7).is_probable_prime());
+	// next_prime, from the table and from the sieve
+	assert(BigInt(-5).next_prime() == BigInt(2));
+	assert(BigInt(13).next_prime() == BigInt(17));
+	assert(BigInt(2).pow(BigInt(64)).next_prime() == BigInt(2).pow(BigInt(64)) + BigInt(13));
+	assert(BigInt(10).pow(BigInt(20)).next_prime() == BigInt("100000000000000000039"));
+	assert(BigInt(3).powmod(BigInt(1000), BigInt(1000000007)) == BigInt(3).pow(BigInt(1000)) % BigInt(1000000007));
+}
+void CheckCombinatorics() {
+	BigInt product(1ll);
+	for (int i = 1; i <= 1000; i++) {
+		product *= BigInt(i);
+		if (i % 97 == 0 || i == 20) assert(BigInt::factorial(i) == product);
+	}
+	assert(BigInt::factorial(1000) == product);
+	assert(BigInt::factorial(0) == BigInt(1));
+	assert(BigInt::factorial(20) == BigInt(2432902008176640000));
+	assert(BigInt::binomial(1000, 500) == product / (BigInt::factorial(500).square()));
+	assert(BigInt::binomial(5, 7) == BigInt(0ll));
+	assert(BigInt::binomial(100000000, 3) == BigInt(100000000) * BigInt(99999999) * BigInt(99999998) / BigInt(6));
+	// small k below the sieve limit, and Pascal's rule across both algorithms
+	assert(BigInt::binomial((1 << 24) - 1, 2) == BigInt((1 << 24) - 1) * BigInt((1 << 23) - 1));
+	assert(BigInt::binomial(2000, 179) == BigInt::binomial(1999, 178) + BigInt::binomial(1999, 179));
+	assert(BigInt::primorial(30) == BigInt(6469693230));
+	assert(BigInt::primorial(1) == BigInt(1));
+}
+void CheckMultiExponentiation() {
+	const BigInt modulus = BigInt(2).pow(BigInt(127)) - BigInt(1);
+	std::vector<BigInt> bases, exponents;
+	BigInt expected = BigInt(1ll);
+	for (int i = 0; i < 40; i++) {
+		bases.push_back(BigInt(3).pow(BigInt(i * 7 + 1)) - BigInt(i));
+		exponents.push_back(BigInt(5).pow(BigInt(i * 3)) + BigInt(i * i));
+		expected = (expected * bases.back().powmod(exponents.back(), modulus)) % modulus;
+		if (i == 1) // g^a * h^b, Straus
+			assert(BigInt::multi_powmod(bases, exponents, modulus) == expected);
+	}
+	assert(BigInt::multi_powmod(bases, exponents, modulus) == expected); // Pippenger
+	assert(BigInt::multi_powmod({}, {}, modulus) == BigInt(1));
+	// fixed base
+	FixedBaseTable table(BigInt(5), modulus, 256);
+	for (const BigInt& e : exponents) {
+		if (e < BigInt(2).pow(BigInt(256)))
+			assert(table.pow(e) == BigInt(5).powmod(e, modulus));
+	}
+	bool thrown = false;
+	try { table.pow(BigInt(2).pow(BigInt(300))); } catch (const std::out_of_range&) { thrown = true; }
+	assert(thrown);
+}
+void CheckLargeDivision() {
+	// q * b + r with |r| < |b| is rebuilt exactly, for divisors that go through the Karatsuba
+	// product, the Burnikel-Ziegler recursion (odd halves included) and the Newton reciprocal
+	uint64_t state = 0x9e3779b97f4a7c15;
+	auto randomNumber = [&state](size_t cells) {
+		BigInt x(1ll);
+		for (size_t i = 0; i < cells; i++) {
+			state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+			x = (x << BigInt(32)) + BigInt(int64_t(state >> 32));
+		}
+		return x;
+	};
+	const size_t sizes[][2] = { { 40, 40 }, { 70, 150 }, { 133, 70 }, { 300, 1000 }, { 2100, 2300 } };
+	for (const auto& size : sizes) {
+		BigInt b = randomNumber(size[0]) >> BigInt(int64_t(size[0] % 31));
+		BigInt q = randomNumber(size[1]);
+		BigInt r = randomNumber(size[0] - 1);
+		BigInt remainder;
+		assert((q * b + r).Divide(b, remainder) == q && remainder == r);
+		assert((-(q * b + r)).Divide(b, remainder) == -q && remainder == -r);
+		assert((q * b) % -b == BigInt(0ll));
+		assert((q * b - BigInt(1)) / b == q - BigInt(1));
+	}
+}
+void CheckExactDivision() {
+	BigInt a = BigInt::factorial(300);
+	const BigInt divisors[] = { BigInt(7), BigInt(1024), BigInt::factorial(40), -BigInt::primorial(200),
+		BigInt(2).pow(BigInt(100)) * BigInt(3).pow(BigInt(50)), BigInt::factorial(299) };
+	for (const BigInt& d : divisors) {
+		assert(a.divexact(d) == a / d);
+		assert((-a).divexact(d) == -a / d);
+	}
+	assert(BigInt(0ll).divexact(BigInt(5)) == BigInt(0ll));
+	// single word divisors, through the cell and the two cells reciprocals
+	const uint64_t words[] = { 1, 3, 10, 1000000000, 0x80000000, UINT32_MAX, uint64_t(UINT32_MAX) + 1,
+		0x123456789abcdefull, 0x8000000000000001ull, UINT64_MAX };
+	for (uint64_t w : words) {
+		BigInt expectedRemainder;
+		const BigInt divisor = BigInt(int64_t(w >> 1)) * BigInt(2) + BigInt(int64_t(w & 1));
+		const BigInt expected = a.Divide(divisor, expectedRemainder);
+		uint64_t remainder = 0;
+		assert(a.divmod_ui(w, remainder) == expected);
+		assert(BigInt(int64_t(remainder >> 1)) * BigInt(2) + BigInt(int64_t(remainder & 1)) == expectedRemainder);
+		assert((-a).divmod_ui(w, remainder) == -expected);
+		if (w <= UINT32_MAX) assert(a.mod_ui(uint32_t(w)) == remainder);
+	}
+}
+void CheckRational() {
+	assert(BigInt::gcd(BigInt::factorial(40), -BigInt(2).pow(BigInt(100))) == BigInt(2).pow(BigInt(38)));
+	assert(BigInt::gcd(BigInt(0ll), BigInt(12)) == BigInt(12));
+	// harmonic numbers: sums of reduced operands stay reduced through Henrici's GCDs
+	BigRational h;
+	for (int i = 1; i <= 30; i++) h += BigRational(BigInt(1), BigInt(i));
+	assert(h.is_normalized());
+	assert(h.BigRationalToString() == "9304682830147/2329089562800");
+	// unreduced operands are left alone until they grow
+	BigRational x(BigInt(6), BigInt(-4));
+	assert(!x.is_normalized() && x == BigRational(BigInt(-3), BigInt(2)));
+	assert(x.numerator() == BigInt(-3) && x.denominator() == BigInt(2));
+	assert(x.BigRationalToString() == "-3/2" && !x.is_normalized()); // const access leaves it as is
+	BigRational sum(BigInt(0ll), BigInt(3)), expected(0ll);
+	for (int i = 1; i <= 200; i++) {
+		sum += BigRational(BigInt(i * 2), BigInt(i * 6));
+		expected += BigRational(BigInt(1), BigInt(3));
+	}
+	assert(sum == expected && sum.BigRationalToString() == "200/3");
+	// mul/div/compare
+	BigRational a(BigInt(-7), BigInt(12)), b(BigInt(35), BigInt(18));
+	a.normalize();
+	b.normalize();
+	assert(a * b == BigRational(BigInt(-245), BigInt(216)));
+	assert(a / b == BigRational(BigInt(-3), BigInt(10)) && (a / b).is_normalized());
+	assert(a < b && b > a && a <= a && -a > a && a - a == BigRational(0ll));
+	bool thrown = false;
+	try { a / BigRational(0ll); } catch (const std::domain_error&) { thrown = true; }
+	assert(thrown);
+}
+void CheckDecimal() {
+	const BigDecimal price("19.99"), quantity("3"), rate("0.0725");
+	assert((price * quantity).BigDecimalToString() == "59.97");
+	assert((price * quantity * rate).BigDecimalToString() == "4.347825");
+	assert((price * quantity * rate).rescale(2).BigDecimalToString() == "4.35");
+	assert((price - BigDecimal("20")).BigDecimalToString() == "-0.01");
+	assert(BigDecimal("1.0") == BigDecimal("1.000") && BigDecimal("-0.5") < BigDecimal("0.25"));
+	assert(BigDecimal(BigInt(5), -3).BigDecimalToString() == "5000" && BigDecimal(".5").scale() == 1);
+	// rounding modes on the ties and on negative values
+	const char* values[] = { "2.5", "-2.5", "1.15", "-1.16" };
+	const RoundingMode modes[] = { RoundingMode::Up, RoundingMode::Down, RoundingMode::Ceiling, RoundingMode::Floor,
+		RoundingMode::HalfUp, RoundingMode::HalfDown, RoundingMode::HalfEven };
+	const char* expected[][7] = {
+		{ "3", "2", "3", "2", "3", "2", "2" },
+		{ "-3", "-2", "-2", "-3", "-3", "-2", "-2" },
+		{ "2", "1", "2", "1", "1", "1", "1" },
+		{ "-2", "-1", "-1", "-2", "-1", "-1", "-1" } };
+	for (int v = 0; v < 4; v++) {
+		for (int m = 0; m < 7; m++)
+			assert(BigDecimal(values[v]).rescale(0, modes[m]).BigDecimalToString() == expected[v][m]);
+	}
+	assert(BigDecimal("1.15").rescale(1, RoundingMode::HalfEven).BigDecimalToString() == "1.2");
+	bool thrown = false;
+	try { BigDecimal("1.15").rescale(1, RoundingMode::Unnecessary); } catch (const std::domain_error&) { thrown = true; }
+	assert(thrown);
+	// division, long scales go through the cached powers of ten
+	assert(BigDecimal(1).divide(BigDecimal(3), 5).BigDecimalToString() == "0.33333");
+	assert(BigDecimal(-2).divide(BigDecimal(3), 3, RoundingMode::HalfUp).BigDecimalToString() == "-0.667");
+	assert((BigDecimal(1) / BigDecimal(8)).rescale(3, RoundingMode::Unnecessary).BigDecimalToString() == "0.125");
+	const BigDecimal third = BigDecimal(1).divide(BigDecimal(3), 500);
+	assert(third.BigDecimalToString() == "0." + std::string(500, '3'));
+	assert((third * BigDecimal(3)).rescale(400, RoundingMode::HalfEven) == BigDecimal(1));
+	assert(BigDecimal("123.456").divide(BigDecimal(BigInt(1), 40), 2).BigDecimalToString() ==
+		"123456" + std::string(37, '0') + ".00");
+	assert(BigDecimal("123.456").divide(BigDecimal(BigInt(1), -2), 3).BigDecimalToString() == "1.235");
+}
+void CheckRns() {
+	// a multiply-add chain in the residues matches the BigInt one while it stays in range
+	auto small = std::make_shared<const RnsBasis>(256);
+	auto large = std::make_shared<const RnsBasis>(4096); // goes down the remainder tree
+	for (const auto& basis : { small, large }) {
+		assert(BigInt(2).pow(BigInt(int64_t(basis->bits() + 1))) < basis->modulus());
+		const BigInt x = BigInt(3).pow(BigInt(int64_t(basis->bits() / 40)));
+		BigInt acc(-1ll);
+		RnsBigInt racc(basis, acc), rx(basis, x), one(basis, 1);
+		for (int i = 0; i < 20; i++) {
+			const BigInt y(int64_t(i) * 1000003 - 5000000);
+			acc = acc * x + y;
+			racc *= rx;
+			racc.addmul(RnsBigInt(basis, y), one);
+		}
+		assert(racc.ToBigInt() == acc);
+		assert((racc - RnsBigInt(basis, acc)).ToBigInt() == BigInt(0ll));
+		assert((-racc).ToBigInt() == -acc && RnsBigInt(basis, -acc) == -racc);
+	}
+	bool thrown = false;
+	try { RnsBigInt(small, 1) + RnsBigInt(large, 1); } catch (const std::invalid_argument&) { thrown = true; }
+	assert(thrown);
+}
+void CheckAsync() {
+	const BigInt a = BigInt(3).pow(BigInt(20000)), b = BigInt(7).pow(BigInt(15000));
+	// default executor, a thread per task
+	std::future<BigInt> product = AsyncMultiply(a, b);
+	std::future<std::pair<BigInt, BigInt>> division = AsyncDivide(a * b + BigInt(5), b);
+	assert(product.get() == a * b);
+	const std::pair<BigInt, BigInt> qr = division.get();
+	assert(qr.first == a && qr.second == BigInt(5));
+	// progress of the outermost operation only, in order, up to 1
+	AsyncOptions options;
+	options.executor = InlineExecutor();
+	std::vector<double> reports;
+	options.progress = [&reports](double fraction) { reports.push_back(fraction); };
+	assert(AsyncPowmod(a, b, BigInt(1000000007), options).get() == a.powmod(b, BigInt(1000000007)));
+	assert(reports.size() > 100 && reports.back() == 1.0);
+	for (size_t i = 1; i < reports.size(); i++) assert(reports[i - 1] <= reports[i]);
+	// a product and a schoolbook division report steps before the final 1
+	reports.clear();
+	assert(AsyncMultiply(a, b, options).get() == a * b);
+	assert(reports.size() > 2 && reports.front() < 1.0 && reports.back() == 1.0);
+	reports.clear();
+	const BigInt divisor = BigInt(10).pow(BigInt(300));
+	assert(AsyncDivide(a, divisor, options).get().first == a / divisor);
+	assert(reports.size() > 2 && reports.front() < 1.0 && reports.back() == 1.0);
+	// work returning nothing, or a reference
+	reports.clear();
+	BigInt sum(0ll);
+	RunAsync([&sum, &a]() { sum += a; }, options).get();
+	const BigInt& ref = RunAsync([&sum]() -> const BigInt& { return sum; }, options).get();
+	assert(sum == a && ref == a && reports.size() == 2);
+	// cancelled before the start, and from the progress callback in the middle of the run
+	bool thrown = false;
+	options.token.cancel();
+	try { AsyncPow(a, BigInt(10), options).get(); } catch (const OperationCancelled&) { thrown = true; }
+	assert(thrown);
+	options.token = CancellationToken();
+	CancellationToken token = options.token;
+	options.progress = [token](double fraction) mutable { if (fraction > 0.5) token.cancel(); };
+	thrown = false;
+	try { AsyncPow(BigInt(3), BigInt(200000), options).get(); } catch (const OperationCancelled&) { thrown = true; }
+	assert(thrown && token.is_cancelled());
+	// a throwing final report fails the future instead of satisfying it twice
+	AsyncOptions failing;
+	failing.executor = InlineExecutor();
+	failing.progress = [](double fraction) { if (fraction == 1.0) throw std::runtime_error("progress"); };
+	thrown = false;
+	try { AsyncMultiply(a, b, failing).get(); } catch (const std::runtime_error& e) { thrown = std::string(e.what()) == "progress"; }
+	assert(thrown);
+	// a nested inline operation hands the checkpoints back to the enclosing one
+	AsyncOptions outer;
+	outer.executor = InlineExecutor();
+	size_t outerReports = 0;
+	outer.progress = [&outerReports](double) { outerReports++; };
+	CancellationToken outerToken = outer.token;
+	thrown = false;
+	std::future<BigInt> nested = RunAsync([&]() {
+		AsyncOptions inner;
+		inner.executor = InlineExecutor();
+		BigInt x = AsyncPow(BigInt(3), BigInt(1000), inner).get();
+		const size_t before = outerReports;
+		x.pow(BigInt(1000));
+		assert(outerReports > before);
+		outerToken.cancel();
+		return x.pow(BigInt(100000));
+	}, outer);
+	try { nested.get(); } catch (const OperationCancelled&) { thrown = true; }
+	assert(thrown);
+	// the checkpoints are off again on this thread
+	assert(BigInt(3).pow(BigInt(100)) == BigInt(3).pow(BigInt(50)).square());
+}
 #pragma endregion
 
 void Demo() {
@@ -179,21 +577,37 @@ void Demo() {
 void Tests() {
 	std::cout << "Runtime checks!\n";
 	CheckConstructors();
-	//CheckBigIntToString();
+	CheckBigIntToString();
 	CheckSum();
 	CheckSub();
 	CheckMul();
-	//CheckTrueDiv();
+	CheckSquare();
+	CheckMulAccumulate();
+	CheckCapacity();
+	CheckLiterals();
+	CheckDivisionByZero();
+	CheckSigns();
+	CheckPrimes();
+	CheckCombinatorics();
+	CheckMultiExponentiation();
+	CheckTrueDiv();
+	CheckLargeDivision();
+	CheckExactDivision();
+	CheckRational();
+	CheckDecimal();
+	CheckRns();
+	CheckAsync();
 	CheckTempDiv();
 	CheckBitOps();
+	CheckSingleBits();
 	CheckBitShifts();
 }
 
 int main()
 {
     {
-		//Tests();
-		CheckTrueDiv();
+		Tests();
+		//CheckTrueDiv();
 		//Demo();
     }
     
@@ -0,0 +1,102 @@
+#include "BigIntAsync.h"
+#include <thread>
+
+namespace bigint {
+
+namespace {
+
+// installed as the checkpoint handler of the thread running an async operation
+void OnCheckpoint(void* context, uint64_t done, uint64_t total) {
+	const AsyncOptions& options = *static_cast<const AsyncOptions*>(context);
+	if (options.token.is_cancelled())
+		throw OperationCancelled();
+	if (total != 0 && options.progress)
+		options.progress(double(done) / double(total));
+}
+
+// binds the handler to options as for an outermost operation, the enclosing operation (if any)
+// gets its handler back when the body returns or throws
+class CheckpointScope {
+public:
+	explicit CheckpointScope(const AsyncOptions& options) : previous(GetCheckpointState()) {
+		SetCheckpointState(CheckpointState{ OnCheckpoint, const_cast<AsyncOptions*>(&options), 0 });
+	}
+	~CheckpointScope() {
+		SetCheckpointState(previous);
+	}
+	CheckpointScope(const CheckpointScope&) = delete;
+private:
+	CheckpointState previous;
+};
+
+} // end of anonymous namespace
+
+/*
+* *******************************************************************
+* CANCELLATION & EXECUTORS
+* *******************************************************************
+*/
+#pragma region cancellation
+
+CancellationToken::CancellationToken() : cancelled(std::make_shared<std::atomic<bool>>(false)) {
+}
+
+void CancellationToken::cancel() {
+	cancelled->store(true);
+}
+
+bool CancellationToken::is_cancelled() const {
+	return cancelled->load();
+}
+
+Executor ThreadExecutor() {
+	return [](std::function<void()> task) { std::thread(std::move(task)).detach(); };
+}
+
+Executor InlineExecutor() {
+	return [](std::function<void()> task) { task(); };
+}
+
+void RunWithCheckpoints(const AsyncOptions& options, const std::function<void()>& body) {
+	if (options.token.is_cancelled())
+		throw OperationCancelled();
+	CheckpointScope scope(options);
+	body();
+	if (options.progress) options.progress(1.0);
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* OPERATIONS
+* *******************************************************************
+*/
+#pragma region operations
+
+std::future<BigInt> AsyncMultiply(const BigInt& a, const BigInt& b, AsyncOptions options) {
+	return RunAsync([a, b]() { return a * b; }, std::move(options));
+}
+
+std::future<BigInt> AsyncPow(const BigInt& base, const BigInt& exponent, AsyncOptions options) {
+	return RunAsync([base, exponent]() {
+		BigInt result = base; // pow is not const
+		return result.pow(exponent);
+	}, std::move(options));
+}
+
+std::future<BigInt> AsyncPowmod(const BigInt& base, const BigInt& exponent, const BigInt& modulus, AsyncOptions options) {
+	return RunAsync([base, exponent, modulus]() { return base.powmod(exponent, modulus); }, std::move(options));
+}
+
+std::future<std::pair<BigInt, BigInt>> AsyncDivide(const BigInt& dividend, const BigInt& divisor, AsyncOptions options) {
+	return RunAsync([dividend, divisor]() {
+		BigInt remainder;
+		BigInt quotient = dividend.Divide(divisor, remainder);
+		return std::make_pair(quotient, remainder);
+	}, std::move(options));
+}
+
+#pragma endregion
+
+} // end of namespace bigint
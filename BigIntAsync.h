@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "BigInt.h"
+
+namespace bigint {
+
+// thrown into the future of an operation cancelled through its token
+class OperationCancelled : public std::runtime_error {
+public:
+	OperationCancelled() : std::runtime_error("BigInt: operation cancelled") {}
+};
+
+// Shared cancellation flag: copies observe the same state. The running operation notices the
+// request at its next checkpoint (between squarings, division blocks, Karatsuba levels).
+class CancellationToken {
+public:
+	CancellationToken();
+	void cancel();
+	bool is_cancelled() const;
+private:
+	std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+// runs a task, on any thread
+using Executor = std::function<void(std::function<void()>)>;
+// fraction of the operation done, in [0, 1], called on the thread running it. The steps are
+// those of the outermost staged operation: exponent bits for the powers, blocks or quotient
+// cells for the divisions, but only the top level sub-products (thirds, fifths for Toom-3,
+// slices of an unbalanced product) for a multiplication. Single cell divisions report nothing
+// before the final 1.
+using ProgressCallback = std::function<void(double)>;
+
+Executor ThreadExecutor(); // a new detached thread per task, the default
+Executor InlineExecutor(); // on the calling thread, the future is ready on return
+
+struct AsyncOptions {
+	Executor executor;          // empty for ThreadExecutor()
+	CancellationToken token;
+	ProgressCallback progress;  // optional
+};
+
+// runs body with the checkpoint handler of the current thread bound to options, then reports
+// a progress of 1, throws OperationCancelled when the token is cancelled
+void RunWithCheckpoints(const AsyncOptions& options, const std::function<void()>& body);
+
+// Runs work() on the executor of options. Cancellation and progress reach the operations
+// that work() calls through the checkpoints of the library. work() may return void, a
+// returned reference is copied into the future.
+template<typename Work>
+auto RunAsync(Work work, AsyncOptions options = {}) -> std::future<std::decay_t<decltype(work())>> {
+	using Result = std::decay_t<decltype(work())>;
+	auto promise = std::make_shared<std::promise<Result>>();
+	std::future<Result> future = promise->get_future();
+	Executor executor = options.executor ? options.executor : ThreadExecutor();
+	executor([promise, work = std::move(work), options]() mutable {
+		// the promise is satisfied once, after the last progress report
+		if constexpr (std::is_void_v<Result>) {
+			try {
+				RunWithCheckpoints(options, [&]() { work(); });
+			}
+			catch (...) {
+				promise->set_exception(std::current_exception());
+				return;
+			}
+			promise->set_value();
+		}
+		else {
+			std::optional<Result> result;
+			try {
+				RunWithCheckpoints(options, [&]() { result.emplace(work()); });
+			}
+			catch (...) {
+				promise->set_exception(std::current_exception());
+				return;
+			}
+			promise->set_value(std::move(*result));
+		}
+	});
+	return future;
+}
+
+// the expensive operations, the operands are copied into the task
+std::future<BigInt> AsyncMultiply(const BigInt& a, const BigInt& b, AsyncOptions options = {});
+std::future<BigInt> AsyncPow(const BigInt& base, const BigInt& exponent, AsyncOptions options = {});
+std::future<BigInt> AsyncPowmod(const BigInt& base, const BigInt& exponent, const BigInt& modulus, AsyncOptions options = {});
+// quotient and remainder, as BigInt::Divide
+std::future<std::pair<BigInt, BigInt>> AsyncDivide(const BigInt& dividend, const BigInt& divisor, AsyncOptions options = {});
+
+} // end of namespace bigint
@@ -0,0 +1,291 @@
+#include "BigRational.h"
+#include <string>
+
+namespace bigint {
+
+namespace {
+
+// cells of the modulo
+size_t Cells(const BigInt& x) {
+	return (x.bit_length() + 31) / 32;
+}
+
+bool IsZero(const BigInt& x) {
+	return x.bit_length() == 0;
+}
+
+bool IsOne(const BigInt& x) {
+	return x == BigInt(1ll);
+}
+
+} // end of anonymous namespace
+
+/*
+* *******************************************************************
+* CONSTRUCTORS & COPY
+* *******************************************************************
+*/
+#pragma region constructors
+
+BigRational::BigRational() : num(0ll), den(1ll), reduced(true), reducedCells(1) {
+}
+
+BigRational::BigRational(int64_t n) : num(n), den(1ll), reduced(true), reducedCells(1) {
+}
+
+BigRational::BigRational(const BigInt& n) : num(n), den(1ll), reduced(true), reducedCells(1) {
+}
+
+BigRational::BigRational(const BigInt& numerator, const BigInt& denominator)
+	: num(numerator), den(denominator), reduced(false), reducedCells(0)
+{
+	if (IsZero(den))
+		throw std::domain_error("BigRational: zero denominator");
+	if (den < BigInt(0ll)) {
+		num = -num;
+		den = -den;
+	}
+	reduced = IsOne(den) || num.bit_length() == 1; // n/1 and +-1/d are in lowest terms
+	reducedCells = Cells(den);
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* ALGEBRA OPERATIONS
+* *******************************************************************
+*/
+#pragma region algebOperations
+
+// a/b + c/d. With both operands reduced and g = gcd(b, d), t = a(d/g) + c(b/g), the sum is
+// (t/g2) / ((b/g)(d/g2)) in lowest terms with g2 = gcd(t, g): two GCDs of operands smaller
+// than the result (Henrici, TAOCP vol. 2, 4.5.1)
+BigRational BigRational::Sum(const BigRational& a, const BigRational& b, bool subtract)
+{
+	BigInt c = subtract ? -b.num : b.num;
+	BigRational result;
+	if (a.den == b.den) {
+		result.num = a.num + c;
+		result.den = a.den;
+		result.reduced = IsOne(result.den);
+		result.reducedCells = std::min(a.reducedCells, b.reducedCells);
+	}
+	else if (a.reduced && b.reduced) {
+		const BigInt g = BigInt::gcd(a.den, b.den);
+		if (IsOne(g)) {
+			result.num = a.num * b.den;
+			result.num.addmul(c, a.den);
+			result.den = a.den * b.den;
+		}
+		else {
+			const BigInt bg = b.den.divexact(g);
+			BigInt t = a.num * bg;
+			t.addmul(c, a.den.divexact(g));
+			const BigInt g2 = BigInt::gcd(t, g);
+			result.num = t.divexact(g2);
+			result.den = a.den.divexact(g) * b.den.divexact(g2);
+		}
+		result.reduced = true;
+		result.reducedCells = Cells(result.den);
+	}
+	else {
+		result.num = a.num * b.den;
+		result.num.addmul(c, a.den);
+		result.den = a.den * b.den;
+		result.reduced = false;
+		result.reducedCells = std::min(a.reducedCells, b.reducedCells);
+	}
+	result.ReduceIfGrown();
+	return result;
+}
+
+BigRational BigRational::operator + (const BigRational& other) const {
+	return Sum(*this, other, false);
+}
+
+BigRational BigRational::operator - (const BigRational& other) const {
+	return Sum(*this, other, true);
+}
+
+// (a/b)(c/d): with both operands reduced, gcd(a, d) and gcd(c, b) are the only common factors
+BigRational BigRational::operator * (const BigRational& other) const {
+	BigRational result;
+	if (reduced && other.reduced) {
+		const BigInt g1 = BigInt::gcd(num, other.den);
+		const BigInt g2 = BigInt::gcd(other.num, den);
+		result.num = num.divexact(g1) * other.num.divexact(g2);
+		result.den = den.divexact(g2) * other.den.divexact(g1);
+		result.reduced = true;
+		result.reducedCells = Cells(result.den);
+	}
+	else {
+		result.num = num * other.num;
+		result.den = den * other.den;
+		result.reduced = false;
+		result.reducedCells = std::min(reducedCells, other.reducedCells);
+		result.ReduceIfGrown();
+	}
+	return result;
+}
+
+BigRational BigRational::operator / (const BigRational& other) const {
+	return *this * other.inverse();
+}
+
+void BigRational::operator += (const BigRational& other) {
+	*this = *this + other;
+}
+
+void BigRational::operator -= (const BigRational& other) {
+	*this = *this - other;
+}
+
+void BigRational::operator *= (const BigRational& other) {
+	*this = *this * other;
+}
+
+void BigRational::operator /= (const BigRational& other) {
+	*this = *this / other;
+}
+
+BigRational BigRational::operator - () const {
+	BigRational result = *this;
+	result.num = -num;
+	return result;
+}
+
+BigRational BigRational::operator + () const {
+	return *this;
+}
+
+BigRational BigRational::inverse() const {
+	if (IsZero(num))
+		throw std::domain_error("BigRational: division by zero");
+	BigRational result = *this;
+	result.num = num < BigInt(0ll) ? -den : den;
+	result.den = num < BigInt(0ll) ? -num : num;
+	result.reducedCells = Cells(result.den);
+	return result;
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* COMPARISONS
+* *******************************************************************
+*/
+#pragma region comparisons
+
+// sign of *this - other: a/b < c/d <=> ad < cb, the denominators being positive
+int BigRational::Compare(const BigRational& other) const {
+	const bool negA = num < BigInt(0ll), negB = other.num < BigInt(0ll);
+	if (negA != negB) return negA ? -1 : 1;
+	BigInt left, right;
+	if (den == other.den) {
+		left = num;
+		right = other.num;
+	}
+	else {
+		left = num * other.den;
+		right = other.num * den;
+	}
+	if (left == right) return 0;
+	return left < right ? -1 : 1;
+}
+
+bool BigRational::operator == (const BigRational& other) const {
+	// lowest terms are unique
+	if (reduced && other.reduced) return num == other.num && den == other.den;
+	return Compare(other) == 0;
+}
+
+bool BigRational::operator != (const BigRational& other) const {
+	return !(*this == other);
+}
+
+bool BigRational::operator < (const BigRational& other) const {
+	return Compare(other) < 0;
+}
+
+bool BigRational::operator > (const BigRational& other) const {
+	return Compare(other) > 0;
+}
+
+bool BigRational::operator <= (const BigRational& other) const {
+	return Compare(other) <= 0;
+}
+
+bool BigRational::operator >= (const BigRational& other) const {
+	return Compare(other) >= 0;
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* NORMALIZATION
+* *******************************************************************
+*/
+#pragma region normalization
+
+void BigRational::normalize() {
+	if (reduced) return;
+	const BigInt g = BigInt::gcd(num, den);
+	if (!IsOne(g)) {
+		num = num.divexact(g);
+		den = den.divexact(g);
+	}
+	reduced = true;
+	reducedCells = Cells(den);
+}
+
+bool BigRational::is_normalized() const {
+	return reduced;
+}
+
+BigInt BigRational::numerator() const {
+	if (reduced) return num;
+	return num.divexact(BigInt::gcd(num, den));
+}
+
+BigInt BigRational::denominator() const {
+	if (reduced) return den;
+	return den.divexact(BigInt::gcd(num, den));
+}
+
+// unreduced results may grow by a constant factor over their reduced size, the reduction
+// is then amortized over several operations
+void BigRational::ReduceIfGrown() {
+	if (!reduced && Cells(den) > 2 * reducedCells + RATIONAL_REDUCE_SLACK)
+		normalize();
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* STRING OPS
+* *******************************************************************
+*/
+#pragma region stringOps
+
+std::ostream& operator << (std::ostream& os, const BigRational& rational) {
+	return os << rational.BigRationalToString();
+}
+
+std::string BigRational::BigRationalToString() const
+{
+	if (!reduced) {
+		BigRational copy = *this;
+		copy.normalize();
+		return copy.BigRationalToString();
+	}
+	if (IsOne(den)) return num.BigIntToString();
+	return num.BigIntToString() + "/" + den.BigIntToString();
+}
+
+#pragma endregion
+
+} // end of namespace bigint
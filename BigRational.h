@@ -0,0 +1,67 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include "BigInt.h"
+
+// an unreduced result is reduced once its denominator outgrows twice its last reduced size
+// plus this many cells
+const size_t RATIONAL_REDUCE_SLACK = 8;
+
+namespace bigint {
+
+// Exact rational numbers num / den with den > 0. Results are not reduced after every operation:
+// products and sums of reduced operands stay reduced through the cheap GCDs of Henrici's
+// formulas, other results are reduced when they outgrow their last reduced size, or by
+// normalize(). Const members never write the value, concurrent const access is safe.
+class BigRational {
+private:
+	BigInt num;
+	BigInt den;          // always positive
+	bool reduced;        // gcd(num, den) == 1
+	size_t reducedCells; // denominator size at the last reduction
+public:
+	// constructors & copy
+	BigRational();
+	BigRational(int64_t);
+	BigRational(const BigInt&);
+	BigRational(const BigInt& numerator, const BigInt& denominator);
+	BigRational(const BigRational&) = default;
+	BigRational& operator = (const BigRational&) = default;
+	// algebra ops
+	BigRational operator + (const BigRational&) const;
+	BigRational operator - (const BigRational&) const;
+	BigRational operator * (const BigRational&) const;
+	BigRational operator / (const BigRational&) const;
+	void operator += (const BigRational&);
+	void operator -= (const BigRational&);
+	void operator *= (const BigRational&);
+	void operator /= (const BigRational&);
+	BigRational operator - () const;
+	BigRational operator + () const;
+	BigRational inverse() const;
+	// comparisons, by cross multiplication, nothing is reduced
+	bool operator == (const BigRational&) const;
+	bool operator != (const BigRational&) const;
+	bool operator < (const BigRational&) const;
+	bool operator > (const BigRational&) const;
+	bool operator <= (const BigRational&) const;
+	bool operator >= (const BigRational&) const;
+	// lowest terms
+	void normalize();
+	bool is_normalized() const;
+	// reduced copies, each costs a GCD unless normalize() ran first
+	BigInt numerator() const;
+	BigInt denominator() const; // positive
+	// print & string ops
+	friend std::ostream& operator << (std::ostream&, const BigRational&);
+	std::string BigRationalToString() const; // "num/den" in lowest terms, "num" for integers
+private:
+	// helpers
+	int Compare(const BigRational& other) const;
+	void ReduceIfGrown();
+	static BigRational Sum(const BigRational& a, const BigRational& b, bool subtract);
+};
+
+std::ostream& operator << (std::ostream& os, const BigRational& rational);
+
+} // end of namespace bigint
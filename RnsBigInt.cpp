@@ -0,0 +1,314 @@
+#include "RnsBigInt.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace bigint {
+
+namespace {
+
+// a * b mod p for a, b < p, p in (2^30, 2^31) and mu = floor(2^62 / p): Barrett's reduction
+// (HAC 14.42), the estimated quotient is short by at most 2
+inline uint32_t MulMod(uint32_t a, uint32_t b, uint32_t p, uint64_t mu) {
+	const uint64_t x = uint64_t(a) * b;
+	const uint64_t q = ((x >> 30) * mu) >> 32;
+	uint64_t r = x - q * p;
+	if (r >= p) r -= p;
+	if (r >= p) r -= p;
+	return uint32_t(r);
+}
+
+// branch free lane sum and difference, a, b < p < 2^31: the wrapped candidate is the larger one
+inline uint32_t AddMod(uint32_t a, uint32_t b, uint32_t p) {
+	const uint32_t s = a + b;
+	return std::min(s, s - p);
+}
+
+inline uint32_t SubMod(uint32_t a, uint32_t b, uint32_t p) {
+	const uint32_t d = a - b;
+	return std::min(d, d + p);
+}
+
+uint32_t PowMod(uint32_t base, uint32_t exponent, uint32_t p) {
+	uint64_t result = 1, b = base % p;
+	for (; exponent > 0; exponent >>= 1) {
+		if (exponent & 1) result = result * b % p;
+		b = b * b % p;
+	}
+	return uint32_t(result);
+}
+
+// deterministic Miller-Rabin, the bases 2, 7 and 61 are enough below 2^32
+bool IsPrimeWord(uint32_t n) {
+	if (n < 2 || n % 2 == 0) return n == 2;
+	uint32_t d = n - 1;
+	unsigned s = 0;
+	while (d % 2 == 0) {
+		d /= 2;
+		s++;
+	}
+	for (uint32_t a : { 2u, 7u, 61u }) {
+		if (a % n == 0) continue;
+		uint64_t x = PowMod(a, d, n);
+		if (x == 1 || x == n - 1) continue;
+		bool composite = true;
+		for (unsigned r = 1; r < s && composite; r++) {
+			x = x * x % n;
+			if (x == n - 1) composite = false;
+		}
+		if (composite) return false;
+	}
+	return true;
+}
+
+} // end of anonymous namespace
+
+/*
+* *******************************************************************
+* BASIS
+* *******************************************************************
+*/
+#pragma region basis
+
+RnsBasis::RnsBasis(size_t bits) : capacityBits(bits)
+{
+	// every prime is above 2^30, so 30 * count > bits + 1 gives M > 2^(bits+1)
+	const size_t count = (bits + 1) / 30 + 1;
+	for (uint32_t candidate = 0x7FFFFFFF; primes.size() < count; candidate -= 2) {
+		if (IsPrimeWord(candidate)) primes.push_back(candidate);
+	}
+	for (uint32_t p : primes)
+		barrett.push_back((uint64_t(1) << 62) / p);
+	// (M / p_i) mod p_i is the product of the other primes, a word product per pair
+	for (size_t i = 0; i < primes.size(); i++) {
+		uint64_t cofactor = 1;
+		for (size_t j = 0; j < primes.size(); j++) {
+			if (j != i) cofactor = cofactor * (primes[j] % primes[i]) % primes[i];
+		}
+		crtFactors.push_back(PowMod(uint32_t(cofactor), primes[i] - 2, primes[i]));
+	}
+	// product tree, an odd node out is carried to the next level unchanged
+	tree.emplace_back();
+	for (uint32_t p : primes) tree[0].push_back(BigInt(int64_t(p)));
+	while (tree.back().size() > 1) {
+		const std::vector<BigInt>& level = tree.back();
+		std::vector<BigInt> next;
+		for (size_t i = 0; i < level.size(); i += 2)
+			next.push_back(i + 1 < level.size() ? level[i] * level[i + 1] : level[i]);
+		tree.push_back(next);
+	}
+}
+
+size_t RnsBasis::size() const {
+	return primes.size();
+}
+
+size_t RnsBasis::bits() const {
+	return capacityBits;
+}
+
+const std::vector<uint32_t>& RnsBasis::moduli() const {
+	return primes;
+}
+
+const BigInt& RnsBasis::modulus() const {
+	return tree.back()[0];
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* CONSTRUCTORS & COPY
+* *******************************************************************
+*/
+#pragma region constructors
+
+RnsBigInt::RnsBigInt(std::shared_ptr<const RnsBasis> basis) : base(std::move(basis))
+{
+	lanes.assign(base->size(), 0);
+}
+
+RnsBigInt::RnsBigInt(std::shared_ptr<const RnsBasis> basis, int64_t value)
+	: RnsBigInt(std::move(basis), BigInt(value))
+{
+}
+
+// residues of |value|: one mod_ui per prime for small bases, otherwise down the remainder tree
+// so that the big reductions are divisions by products of similar size
+RnsBigInt::RnsBigInt(std::shared_ptr<const RnsBasis> basis, const BigInt& value) : base(std::move(basis))
+{
+	const std::vector<uint32_t>& primes = base->primes;
+	const std::vector<std::vector<BigInt>>& tree = base->tree;
+	lanes.assign(primes.size(), 0);
+	const bool negative = value < BigInt(0ll);
+	if (primes.size() < RNS_REMAINDER_TREE_THRESHOLD) {
+		for (size_t i = 0; i < primes.size(); i++)
+			lanes[i] = value.mod_ui(primes[i]);
+	}
+	else {
+		std::vector<BigInt> level(1, (negative ? -value : value) % tree.back()[0]);
+		for (size_t j = tree.size() - 1; j-- > 1;) {
+			std::vector<BigInt> next;
+			for (size_t i = 0; i < tree[j].size(); i++)
+				next.push_back(level[i / 2] % tree[j][i]);
+			level = next;
+		}
+		for (size_t i = 0; i < primes.size(); i++)
+			lanes[i] = level[i / 2].mod_ui(primes[i]);
+	}
+	if (negative) {
+		for (size_t i = 0; i < primes.size(); i++)
+			lanes[i] = SubMod(0, lanes[i], primes[i]);
+	}
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* ALGEBRA OPERATIONS
+* *******************************************************************
+*/
+#pragma region algebOperations
+
+RnsBigInt RnsBigInt::operator + (const RnsBigInt& other) const {
+	RnsBigInt result = *this;
+	result += other;
+	return result;
+}
+
+RnsBigInt RnsBigInt::operator - (const RnsBigInt& other) const {
+	RnsBigInt result = *this;
+	result -= other;
+	return result;
+}
+
+RnsBigInt RnsBigInt::operator * (const RnsBigInt& other) const {
+	RnsBigInt result = *this;
+	result *= other;
+	return result;
+}
+
+void RnsBigInt::operator += (const RnsBigInt& other) {
+	CheckBasis(other);
+	const uint32_t* primes = base->primes.data();
+	const uint32_t* b = other.lanes.data();
+	uint32_t* a = lanes.data();
+	for (size_t i = 0, n = lanes.size(); i < n; i++)
+		a[i] = AddMod(a[i], b[i], primes[i]);
+}
+
+void RnsBigInt::operator -= (const RnsBigInt& other) {
+	CheckBasis(other);
+	const uint32_t* primes = base->primes.data();
+	const uint32_t* b = other.lanes.data();
+	uint32_t* a = lanes.data();
+	for (size_t i = 0, n = lanes.size(); i < n; i++)
+		a[i] = SubMod(a[i], b[i], primes[i]);
+}
+
+void RnsBigInt::operator *= (const RnsBigInt& other) {
+	CheckBasis(other);
+	const uint32_t* primes = base->primes.data();
+	const uint64_t* mu = base->barrett.data();
+	const uint32_t* b = other.lanes.data();
+	uint32_t* a = lanes.data();
+	for (size_t i = 0, n = lanes.size(); i < n; i++)
+		a[i] = MulMod(a[i], b[i], primes[i], mu[i]);
+}
+
+RnsBigInt RnsBigInt::operator - () const {
+	RnsBigInt result(base);
+	result -= *this;
+	return result;
+}
+
+void RnsBigInt::addmul(const RnsBigInt& x, const RnsBigInt& y) {
+	CheckBasis(x);
+	CheckBasis(y);
+	const uint32_t* primes = base->primes.data();
+	const uint64_t* mu = base->barrett.data();
+	for (size_t i = 0, n = lanes.size(); i < n; i++)
+		lanes[i] = AddMod(lanes[i], MulMod(x.lanes[i], y.lanes[i], primes[i], mu[i]), primes[i]);
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* COMPARISONS
+* *******************************************************************
+*/
+#pragma region comparisons
+
+bool RnsBigInt::operator == (const RnsBigInt& other) const {
+	CheckBasis(other);
+	return lanes == other.lanes;
+}
+
+bool RnsBigInt::operator != (const RnsBigInt& other) const {
+	return !(*this == other);
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* CONVERSIONS
+* *******************************************************************
+*/
+#pragma region conversions
+
+// CRT: x = sum of v_i * M / p_i mod M with v_i = r_i * (M / p_i)^-1 mod p_i. The sum is built
+// up the product tree, a node being left * rightProduct + right * leftProduct
+BigInt RnsBigInt::ToBigInt() const {
+	const std::vector<uint32_t>& primes = base->primes;
+	const std::vector<std::vector<BigInt>>& tree = base->tree;
+	std::vector<BigInt> level;
+	for (size_t i = 0; i < primes.size(); i++)
+		level.push_back(BigInt(int64_t(MulMod(lanes[i], base->crtFactors[i], primes[i], base->barrett[i]))));
+	for (size_t j = 0; j + 1 < tree.size(); j++) {
+		std::vector<BigInt> next;
+		for (size_t i = 0; i < level.size(); i += 2) {
+			if (i + 1 == level.size()) {
+				next.push_back(level[i]);
+				continue;
+			}
+			BigInt node = level[i] * tree[j][i + 1];
+			node.addmul(level[i + 1], tree[j][i]);
+			next.push_back(node);
+		}
+		level = next;
+	}
+	const BigInt& modulus = tree.back()[0];
+	BigInt x = level[0] % modulus;
+	// M is odd, the upper half maps to the negative values
+	if ((x + x) > modulus) x -= modulus;
+	return x;
+}
+
+const std::vector<uint32_t>& RnsBigInt::residues() const {
+	return lanes;
+}
+
+const std::shared_ptr<const RnsBasis>& RnsBigInt::basis() const {
+	return base;
+}
+
+#pragma endregion
+
+/*
+* *******************************************************************
+* UTILITIES
+* *******************************************************************
+*/
+#pragma region utilities
+
+void RnsBigInt::CheckBasis(const RnsBigInt& other) const {
+	if (base != other.base && base->primes != other.base->primes)
+		throw std::invalid_argument("RnsBigInt: operands on different bases");
+}
+
+#pragma endregion
+
+} // end of namespace bigint
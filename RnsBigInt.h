@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "BigInt.h"
+
+// conversions from BigInt go down a remainder tree from this many primes on
+const size_t RNS_REMAINDER_TREE_THRESHOLD = 16;
+
+namespace bigint {
+
+// A set of distinct primes in (2^30, 2^31) whose product M exceeds 2^(bits+1), with the
+// product tree and the CRT constants used by the conversions. Shared by the RnsBigInt values
+// built on it.
+class RnsBasis {
+public:
+	explicit RnsBasis(size_t bits); // values with |x| < 2^bits are represented exactly
+	size_t size() const;            // number of primes (lanes)
+	size_t bits() const;
+	const std::vector<uint32_t>& moduli() const;
+	const BigInt& modulus() const;  // M, the product of the primes
+private:
+	friend class RnsBigInt;
+	size_t capacityBits;
+	std::vector<uint32_t> primes;
+	std::vector<uint64_t> barrett;         // floor(2^62 / p), for reductions without division
+	std::vector<uint32_t> crtFactors;      // (M / p)^-1 mod p
+	std::vector<std::vector<BigInt>> tree; // products of the primes, level 0 are the primes
+};
+
+// Residue number system: an integer held as its residues modulo the primes of a basis. Sums,
+// differences and products are independent per lane word operations, without carries, so the
+// lane loops vectorize and several values can be processed in parallel. Arithmetic is modulo M:
+// ToBigInt returns the representative in (-M/2, M/2].
+class RnsBigInt {
+public:
+	// constructors & copy
+	explicit RnsBigInt(std::shared_ptr<const RnsBasis> basis); // zero
+	RnsBigInt(std::shared_ptr<const RnsBasis> basis, int64_t value);
+	RnsBigInt(std::shared_ptr<const RnsBasis> basis, const BigInt& value);
+	RnsBigInt(const RnsBigInt&) = default;
+	RnsBigInt& operator = (const RnsBigInt&) = default;
+	// algebra ops, lane by lane; operands must share the basis (std::invalid_argument otherwise)
+	RnsBigInt operator + (const RnsBigInt&) const;
+	RnsBigInt operator - (const RnsBigInt&) const;
+	RnsBigInt operator * (const RnsBigInt&) const;
+	void operator += (const RnsBigInt&);
+	void operator -= (const RnsBigInt&);
+	void operator *= (const RnsBigInt&);
+	RnsBigInt operator - () const;
+	void addmul(const RnsBigInt& x, const RnsBigInt& y); // *this += x * y in a single pass
+	// comparisons, equality modulo M only
+	bool operator == (const RnsBigInt&) const;
+	bool operator != (const RnsBigInt&) const;
+	// conversion back, CRT up the product tree of the basis
+	BigInt ToBigInt() const;
+	const std::vector<uint32_t>& residues() const;
+	const std::shared_ptr<const RnsBasis>& basis() const;
+private:
+	std::shared_ptr<const RnsBasis> base;
+	std::vector<uint32_t> lanes;
+	// helpers
+	void CheckBasis(const RnsBigInt& other) const;
+};
+
+} // end of namespace bigint